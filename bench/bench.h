@@ -0,0 +1,44 @@
+#ifndef C_RESULT_BENCH_H
+#define C_RESULT_BENCH_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+// Allocation counting hooks, installed before c_result.h is included
+extern size_t bench_allocations;
+
+static inline void *bench_malloc(const size_t size) {
+    bench_allocations++;
+    return malloc(size);
+}
+
+static inline void *bench_realloc(void *ptr, const size_t size) {
+    bench_allocations++;
+    return realloc(ptr, size);
+}
+
+#define C_RESULT_MALLOC(size) bench_malloc(size)
+#define C_RESULT_REALLOC(ptr, size) bench_realloc(ptr, size)
+#define C_RESULT_FREE(ptr) free(ptr)
+
+#include "c_result.h"
+
+// Keeps the compiler from optimizing a value away
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_ESCAPE(value) __asm__ volatile("" : : "g"(value) : "memory")
+#else
+extern volatile uintptr_t bench_sink;
+#define BENCH_ESCAPE(value) (bench_sink += (uintptr_t) (value))
+#endif
+
+// Number of results built up front by the benchmarks that only time freeing or access
+#define BENCH_BLOCK 1024
+
+double bench_now_ns(void);
+void bench_report(const char *name, double elapsed_ns, size_t operations, size_t allocations);
+
+// Accessor benchmarks, compiled once with DEBUG and once without
+void bench_access_debug(const Result *results, size_t count, size_t rounds);
+void bench_access_release(const Result *results, size_t count, size_t rounds);
+
+#endif // C_RESULT_BENCH_H
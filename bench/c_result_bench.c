@@ -0,0 +1,177 @@
+// Micro-benchmarks for the constructors, accessors and free_result(), and of result_parallel_map() against the
+// serial loop it replaces.
+// Usage: c_result_bench [iterations]. Build in Release mode for meaningful numbers.
+// clock_gettime() and CLOCK_MONOTONIC are POSIX, hidden by a strict -std=c99/c11
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include "bench.h"
+#include "c_result_parallel.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+size_t bench_allocations = 0;
+#if !defined(__GNUC__) && !defined(__clang__)
+volatile uintptr_t bench_sink = 0;
+#endif
+
+double bench_now_ns(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart * 1e9 / (double) frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+#endif
+}
+
+void bench_report(const char *name, const double elapsed_ns, const size_t operations, const size_t allocations) {
+    printf("%-40s %10.2f ns/op %8.2f allocs/op\n", name, elapsed_ns / (double) operations,
+           (double) allocations / (double) operations);
+}
+
+void bench_access_release(const Result *results, const size_t count, const size_t rounds) {
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < count; i++) {
+            int value = access_result_int(results[i]);
+            BENCH_ESCAPE(value);
+        }
+    }
+}
+
+static void noop_destructor(void *data) {
+    (void) data;
+}
+
+static char bench_payload[16];
+
+static const char *long_message =
+    "A long error message that does not fit any inline buffer, so constructing it always goes to the allocator "
+    "and freeing it always releases heap memory again";
+
+// Times constructing and freeing one result per iteration
+#define BENCH_CONSTRUCT(name, iterations, expression) \
+    do { \
+        const size_t allocations_before_ = bench_allocations; \
+        const double start_ = bench_now_ns(); \
+        for (size_t i_ = 0; i_ < (iterations); i_++) { \
+            Result res_ = (expression); \
+            BENCH_ESCAPE(&res_); \
+            free_result(&res_); \
+        } \
+        bench_report(name, bench_now_ns() - start_, iterations, bench_allocations - allocations_before_); \
+    } while (0)
+
+// Times free_result() alone, on blocks of results built outside of the measurement
+#define BENCH_FREE(name, iterations, expression) \
+    do { \
+        static Result block_[BENCH_BLOCK]; \
+        double elapsed_ = 0; \
+        size_t done_ = 0; \
+        while (done_ < (iterations)) { \
+            for (size_t i_ = 0; i_ < BENCH_BLOCK; i_++) { \
+                block_[i_] = (expression); \
+            } \
+            const double start_ = bench_now_ns(); \
+            for (size_t i_ = 0; i_ < BENCH_BLOCK; i_++) { \
+                free_result(&block_[i_]); \
+            } \
+            elapsed_ += bench_now_ns() - start_; \
+            BENCH_ESCAPE(block_); \
+            done_ += BENCH_BLOCK; \
+        } \
+        bench_report(name, elapsed_, done_, 0); \
+    } while (0)
+
+static char *duplicate(const char *text) {
+    const size_t size = strlen(text) + 1;
+    char *copy = malloc(size);
+    memcpy(copy, text, size);
+    return copy;
+}
+
+static Result bench_item(void *context, const size_t index) {
+    (void) context;
+    return make_success_int64((int64_t) (index * 2654435761u));
+}
+
+// Times filling a batch of items results, per item: with a serial loop when threads is 0, with the map otherwise
+static void bench_parallel(const char *name, const size_t items, const size_t threads, const size_t iterations) {
+    ResultBatch batch;
+    if (result_batch_init(&batch, items) != SUCCESS) {
+        return;
+    }
+    const size_t calls = iterations / items + 1;
+    const size_t allocations_before = bench_allocations;
+    const double start = bench_now_ns();
+    for (size_t call = 0; call < calls; call++) {
+        if (threads) {
+            (void) result_parallel_map(&batch, items, bench_item, NULL, threads, 0);
+        } else {
+            for (size_t i = 0; i < items; i++) {
+                (void) result_batch_push(&batch, bench_item(NULL, i));
+            }
+        }
+        BENCH_ESCAPE(batch.codes);
+        result_batch_clear(&batch);
+    }
+    bench_report(name, bench_now_ns() - start, calls * items, bench_allocations - allocations_before);
+    result_batch_free_all(&batch);
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 1000000;
+    printf("c_result_bench: %zu iterations, sizeof(Result) = %zu\n\n", iterations, sizeof(Result));
+
+    printf("Constructors (construct + free_result)\n");
+    BENCH_CONSTRUCT("make_success_int", iterations, make_success_int((int) i_));
+    BENCH_CONSTRUCT("make_success_custom (borrowed)", iterations,
+                    make_success_custom(bench_payload, noop_destructor, false));
+    BENCH_CONSTRUCT("make_success_custom (owned)", iterations,
+                    make_success_custom(bench_payload, noop_destructor, true));
+    BENCH_CONSTRUCT("make_error (short message)", iterations, make_error(ERR_INVALID_INPUT, "Bad input"));
+    BENCH_CONSTRUCT("make_error (long message)", iterations, make_error(ERR_INVALID_INPUT, long_message));
+    BENCH_CONSTRUCT("make_error_static", iterations, make_error_static(ERR_INVALID_INPUT, long_message));
+    BENCH_CONSTRUCT("make_errorf (inline)", iterations, make_errorf(ERR_OUT_OF_RANGE, "Index %zu", i_ & 0xFF));
+
+    printf("\nfree_result (owned payloads, allocations happen outside the measurement)\n");
+    BENCH_FREE("free_result int", iterations, make_success_int(1));
+    BENCH_FREE("free_result ptr", iterations, make_success_ptr(malloc(16), true));
+    BENCH_FREE("free_result string", iterations, make_success_string(duplicate("payload"), true));
+    BENCH_FREE("free_result custom", iterations, make_success_custom(malloc(16), free, true));
+    BENCH_FREE("free_result shared", iterations, make_success_shared(malloc(16), free));
+    BENCH_FREE("free_result error (heap message)", iterations, make_error(ERR_INVALID_INPUT, long_message));
+
+    printf("\nAccessors (access_result_int)\n");
+    static Result block[BENCH_BLOCK];
+    for (size_t i = 0; i < BENCH_BLOCK; i++) {
+        block[i] = make_success_int((int) i);
+    }
+    const size_t rounds = iterations / BENCH_BLOCK + 1;
+    double start = bench_now_ns();
+    bench_access_release(block, BENCH_BLOCK, rounds);
+    bench_report("access_result_int (release)", bench_now_ns() - start, rounds * BENCH_BLOCK, 0);
+    start = bench_now_ns();
+    bench_access_debug(block, BENCH_BLOCK, rounds);
+    bench_report("access_result_int (DEBUG)", bench_now_ns() - start, rounds * BENCH_BLOCK, 0);
+
+    // The pool threads are started by the first map and reused by the next ones, so small batches pay one wake-up
+    // per worker and call, not a thread creation
+    printf("\nParallel map (per item, %u processors)\n", c_result_parallel_processors());
+    bench_parallel("serial loop (64 items)", 64, 0, iterations);
+    bench_parallel("result_parallel_map 4 threads (64)", 64, 4, iterations);
+    bench_parallel("serial loop (65536 items)", 65536, 0, iterations);
+    bench_parallel("result_parallel_map 4 threads (65536)", 65536, 4, iterations);
+    bench_parallel("result_parallel_map all (65536)", 65536, c_result_parallel_processors(), iterations);
+    (void) c_result_parallel_pool_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+// Accessor benchmarks with the checked DEBUG accessors
+#define DEBUG
+#include "bench.h"
+
+void bench_access_debug(const Result *results, const size_t count, const size_t rounds) {
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < count; i++) {
+            int value = access_result_int(results[i]);
+            BENCH_ESCAPE(value);
+        }
+    }
+}
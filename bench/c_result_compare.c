@@ -0,0 +1,457 @@
+// Comparative benchmark: the same workload (see compare.h) implemented with Result, with an errno-style int return
+// plus out-parameters, with setjmp/longjmp and, when a C++23 compiler is available, with std::expected.
+// Reports cycles, instructions and stack usage per record, on a success-heavy and an error-heavy input.
+// Usage: c_result_compare [iterations]. Build in Release mode for meaningful numbers.
+//
+// The errors here use make_error_static(), so no message is copied and Result pays for its layout alone:
+// - A Result is 32 bytes (16 with C_RESULT_COMPACT). Above 16 bytes it is returned through a hidden pointer into the
+//   caller's frame, where the int return and std::expected<int, int> travel in registers, and every constructor
+//   writes the whole struct. Next to the parsing and the heap buffer of each record, these stores are cheap.
+// - Every intermediate Result goes through free_result(), which tests the ownership and the message storage even
+//   when nothing is owned, and the record buffer is freed through it instead of a plain free().
+// make_error() would add a strlen() and an allocation per error on top (or an arena copy, see
+// c_result_thread_arena_init()). What that buys is a message, an origin and a context chain per error.
+// clock_gettime() is POSIX and syscall(), for perf_event_open(), a BSD extension: both are hidden by a strict
+// -std=c99/c11
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+#include <setjmp.h>
+#include <stdio.h>
+#include "c_result.h"
+#include "compare.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define COMPARE_HAVE_TSC
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COMPARE_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define COMPARE_NOINLINE __declspec(noinline)
+#else
+#define COMPARE_NOINLINE
+#endif
+
+// Result
+
+static Result result_read_record(const char *source) {
+    if (!source) {
+        return make_error_static(COMPARE_ERR_NOT_FOUND, "Record not found");
+    }
+    const size_t size = strlen(source) + 1;
+    char *buffer = malloc(size);
+    if (!buffer) {
+        return make_error_static(ERR_OUT_OF_MEMORY, "Failed to allocate memory");
+    }
+    memcpy(buffer, source, size);
+    return make_success_string(buffer, true);
+}
+
+static Result result_parse_number(const char **cursor) {
+    const char *text = *cursor;
+    if (*text < '0' || *text > '9') {
+        return make_error_static(COMPARE_ERR_PARSE, "Expected a number");
+    }
+    int value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+    }
+    *cursor = text;
+    return make_success_int(value);
+}
+
+static Result result_divide_numbers(const int a, const int b) {
+    if (b == 0) {
+        return make_error_static(COMPARE_ERR_DIVISION, "Division by zero");
+    }
+    return make_success_int(a / b);
+}
+
+static Result result_process_record(const char *source) {
+    Result buffer = result_read_record(source);
+    if (!is_result_success(buffer)) {
+        return buffer;
+    }
+    const char *cursor = access_result_string(buffer);
+    Result a = result_parse_number(&cursor);
+    if (!is_result_success(a)) {
+        free_result(&buffer);
+        return a;
+    }
+    if (*cursor++ != '/') {
+        free_result(&buffer);
+        return make_error_static(COMPARE_ERR_PARSE, "Expected '/'");
+    }
+    Result b = result_parse_number(&cursor);
+    free_result(&buffer);
+    if (!is_result_success(b)) {
+        return b;
+    }
+    return result_divide_numbers(access_result_int(a), access_result_int(b));
+}
+
+static long result_run(const char *const *records, const size_t count) {
+    long checksum = 0;
+    for (size_t i = 0; i < count; i++) {
+        Result res = result_process_record(records[i]);
+        checksum += is_result_success(res) ? access_result_int(res) : res.code;
+        free_result(&res);
+    }
+    return checksum;
+}
+
+// errno-style int return plus out-parameters
+
+static int errno_read_record(const char *source, char **out) {
+    if (!source) {
+        return COMPARE_ERR_NOT_FOUND;
+    }
+    const size_t size = strlen(source) + 1;
+    char *buffer = malloc(size);
+    if (!buffer) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    memcpy(buffer, source, size);
+    *out = buffer;
+    return 0;
+}
+
+static int errno_parse_number(const char **cursor, int *out) {
+    const char *text = *cursor;
+    if (*text < '0' || *text > '9') {
+        return COMPARE_ERR_PARSE;
+    }
+    int value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+    }
+    *cursor = text;
+    *out = value;
+    return 0;
+}
+
+static int errno_divide_numbers(const int a, const int b, int *out) {
+    if (b == 0) {
+        return COMPARE_ERR_DIVISION;
+    }
+    *out = a / b;
+    return 0;
+}
+
+static int errno_process_record(const char *source, int *out) {
+    char *buffer;
+    int status = errno_read_record(source, &buffer);
+    if (status) {
+        return status;
+    }
+    const char *cursor = buffer;
+    int a = 0, b = 0;
+    if ((status = errno_parse_number(&cursor, &a)) == 0) {
+        if (*cursor++ != '/') {
+            status = COMPARE_ERR_PARSE;
+        } else {
+            status = errno_parse_number(&cursor, &b);
+        }
+    }
+    free(buffer);
+    return status ? status : errno_divide_numbers(a, b, out);
+}
+
+static long errno_run(const char *const *records, const size_t count) {
+    long checksum = 0;
+    for (size_t i = 0; i < count; i++) {
+        int value;
+        const int status = errno_process_record(records[i], &value);
+        checksum += status ? status : value;
+    }
+    return checksum;
+}
+
+// setjmp/longjmp: errors unwind straight to the loop, which releases the record buffer
+
+typedef struct {
+    jmp_buf unwind;
+    char *volatile buffer; // Owned by the loop, so that it survives the longjmp
+} JumpContext;
+
+static char *jump_read_record(JumpContext *context, const char *source) {
+    if (!source) {
+        longjmp(context->unwind, COMPARE_ERR_NOT_FOUND);
+    }
+    const size_t size = strlen(source) + 1;
+    char *buffer = malloc(size);
+    if (!buffer) {
+        longjmp(context->unwind, ERR_OUT_OF_MEMORY);
+    }
+    memcpy(buffer, source, size);
+    return buffer;
+}
+
+static int jump_parse_number(JumpContext *context, const char **cursor) {
+    const char *text = *cursor;
+    if (*text < '0' || *text > '9') {
+        longjmp(context->unwind, COMPARE_ERR_PARSE);
+    }
+    int value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+    }
+    *cursor = text;
+    return value;
+}
+
+static int jump_divide_numbers(JumpContext *context, const int a, const int b) {
+    if (b == 0) {
+        longjmp(context->unwind, COMPARE_ERR_DIVISION);
+    }
+    return a / b;
+}
+
+static int jump_process_record(JumpContext *context, const char *source) {
+    context->buffer = jump_read_record(context, source);
+    const char *cursor = context->buffer;
+    const int a = jump_parse_number(context, &cursor);
+    if (*cursor++ != '/') {
+        longjmp(context->unwind, COMPARE_ERR_PARSE);
+    }
+    const int b = jump_parse_number(context, &cursor);
+    free(context->buffer);
+    context->buffer = NULL;
+    return jump_divide_numbers(context, a, b);
+}
+
+static long jump_run(const char *const *records, const size_t count) {
+    JumpContext context;
+    context.buffer = NULL;
+    volatile long checksum = 0;
+    for (volatile size_t i = 0; i < count; i++) {
+        const int status = setjmp(context.unwind);
+        if (status == 0) {
+            checksum += jump_process_record(&context, records[i]);
+        } else {
+            free(context.buffer);
+            context.buffer = NULL;
+            checksum += status;
+        }
+    }
+    return checksum;
+}
+
+// Hardware counters: perf_event_open on Linux, the time stamp counter otherwise
+
+typedef struct {
+    int cycles; // perf group leader, -1 when unavailable
+    int instructions;
+} Counters;
+
+typedef struct {
+    double ns;
+    double cycles; // Negative when unavailable
+    double instructions;
+} Sample;
+
+#if defined(__linux__)
+static int counters_open(const uint64_t config, const int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+static Counters counters_init(void) {
+    Counters counters = {-1, -1};
+#if defined(__linux__)
+    counters.cycles = counters_open(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (counters.cycles >= 0) {
+        counters.instructions = counters_open(PERF_COUNT_HW_INSTRUCTIONS, counters.cycles);
+    }
+#endif
+    return counters;
+}
+
+static double now_ns(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart * 1e9 / (double) frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+#endif
+}
+
+static Sample measure(const Counters *counters, const CompareRun run, const char *const *records, const size_t count,
+                      long *checksum) {
+    Sample sample = {0, -1, -1};
+#if defined(__linux__)
+    if (counters->cycles >= 0) {
+        ioctl(counters->cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(counters->cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    (void) counters;
+#endif
+#ifdef COMPARE_HAVE_TSC
+    const uint64_t tsc = __rdtsc();
+#endif
+    const double start = now_ns();
+    *checksum = run(records, count);
+    sample.ns = now_ns() - start;
+#ifdef COMPARE_HAVE_TSC
+    sample.cycles = (double) (__rdtsc() - tsc); // Reference cycles, replaced by core cycles when perf is available
+#endif
+#if defined(__linux__)
+    if (counters->cycles >= 0) {
+        ioctl(counters->cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[3] = {0}; // Number of events, cycles, instructions
+        if (read(counters->cycles, values, sizeof(values)) > 0) {
+            sample.cycles = (double) values[1];
+            sample.instructions = counters->instructions >= 0 && values[0] > 1 ? (double) values[2] : -1;
+        }
+    }
+#endif
+    return sample;
+}
+
+// Stack painting: fill a region below the current frame with a pattern, run the workload from the same depth and
+// look for the deepest byte it overwrote. Assumes a downward-growing stack.
+#define COMPARE_STACK_PAINT 0xA5
+#define COMPARE_STACK_REGION (64 * 1024)
+
+// Returns the lowest address of the painted region
+COMPARE_NOINLINE static uintptr_t stack_paint(void) {
+    volatile unsigned char region[COMPARE_STACK_REGION];
+    for (size_t i = 0; i < sizeof(region); i++) {
+        region[i] = COMPARE_STACK_PAINT;
+    }
+    return (uintptr_t) region;
+}
+
+COMPARE_NOINLINE static size_t stack_measure(const uintptr_t base) {
+    const volatile unsigned char *region = (const volatile unsigned char *) base;
+    size_t untouched = 0;
+    while (untouched < COMPARE_STACK_REGION && region[untouched] == COMPARE_STACK_PAINT) {
+        untouched++;
+    }
+    return COMPARE_STACK_REGION - untouched;
+}
+
+COMPARE_NOINLINE static size_t stack_usage(const CompareRun run, const char *const *records, const size_t count) {
+    const uintptr_t base = stack_paint();
+    const long checksum = run(records, count);
+    const size_t used = stack_measure(base);
+    (void) checksum;
+    return used;
+}
+
+// Driver
+
+typedef struct {
+    const char *name;
+    CompareRun run;
+} Implementation;
+
+static void report(const char *name, const Sample *sample, const size_t operations, const size_t stack,
+                   const long checksum) {
+    printf("  %-16s %9.2f ns/op", name, sample->ns / (double) operations);
+    if (sample->cycles >= 0) {
+        printf(" %9.2f cycles/op", sample->cycles / (double) operations);
+    } else {
+        printf(" %9s cycles/op", "n/a");
+    }
+    if (sample->instructions >= 0) {
+        printf(" %9.2f instructions/op", sample->instructions / (double) operations);
+    } else {
+        printf(" %9s instructions/op", "n/a");
+    }
+    printf(" %7zu stack bytes  (checksum %ld)\n", stack, checksum);
+}
+
+static const char *const success_records[] = {"84/2", "1000/7", "9/3", "123456/789"};
+static const char *const error_records[] = {NULL, "12/x", "7/0", "x/5"};
+
+#define COMPARE_RECORDS 4
+#define COMPARE_BLOCK 1024
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 1000000;
+    const Implementation implementations[] = {
+        {"Result", result_run},
+        {"errno/out-param", errno_run},
+        {"setjmp/longjmp", jump_run},
+#ifdef C_RESULT_COMPARE_EXPECTED
+        {"std::expected", compare_expected_run},
+#endif
+    };
+    const struct {
+        const char *name;
+        const char *const *records;
+    } paths[] = {{"Success-heavy", success_records}, {"Error-heavy", error_records}};
+
+    // Blocks of records, so that each run amortizes the counter overhead
+    static const char *block[COMPARE_BLOCK];
+    const size_t blocks = iterations / COMPARE_BLOCK + 1;
+    const Counters counters = counters_init();
+
+    printf("c_result_compare: %zu records per path, counters: %s\n", blocks * COMPARE_BLOCK,
+           counters.cycles >= 0 ? "perf" :
+#ifdef COMPARE_HAVE_TSC
+           "time stamp counter (reference cycles)"
+#else
+           "none"
+#endif
+    );
+#ifndef C_RESULT_COMPARE_EXPECTED
+    printf("std::expected: skipped, no C++23 compiler\n");
+#endif
+
+    for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++) {
+        for (size_t i = 0; i < COMPARE_BLOCK; i++) {
+            block[i] = paths[p].records[i % COMPARE_RECORDS];
+        }
+        printf("\n%s\n", paths[p].name);
+        for (size_t m = 0; m < sizeof(implementations) / sizeof(implementations[0]); m++) {
+            Sample total = {0, 0, 0};
+            long checksum = 0;
+            for (size_t b = 0; b < blocks; b++) {
+                const Sample sample = measure(&counters, implementations[m].run, block, COMPARE_BLOCK, &checksum);
+                total.ns += sample.ns;
+                total.cycles = sample.cycles < 0 || total.cycles < 0 ? -1 : total.cycles + sample.cycles;
+                total.instructions = sample.instructions < 0 || total.instructions < 0 ? -1 :
+                                     total.instructions + sample.instructions;
+            }
+            const size_t stack = stack_usage(implementations[m].run, paths[p].records, COMPARE_RECORDS);
+            report(implementations[m].name, &total, blocks * COMPARE_BLOCK, stack, checksum);
+        }
+    }
+    return 0;
+}
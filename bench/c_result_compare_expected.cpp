@@ -0,0 +1,74 @@
+// std::expected implementation of the comparative benchmark workload, see compare.h
+#include <cstdlib>
+#include <cstring>
+#include <expected>
+#include <memory>
+#include "compare.h"
+
+namespace {
+
+struct Error {
+    int code;
+    const char *message;
+};
+
+std::expected<std::unique_ptr<char[]>, Error> read_record(const char *source) {
+    if (!source) {
+        return std::unexpected(Error{COMPARE_ERR_NOT_FOUND, "Record not found"});
+    }
+    const size_t size = std::strlen(source) + 1;
+    std::unique_ptr<char[]> buffer(new char[size]);
+    std::memcpy(buffer.get(), source, size);
+    return buffer;
+}
+
+std::expected<int, Error> parse_number(const char **cursor) {
+    const char *text = *cursor;
+    if (*text < '0' || *text > '9') {
+        return std::unexpected(Error{COMPARE_ERR_PARSE, "Expected a number"});
+    }
+    int value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+    }
+    *cursor = text;
+    return value;
+}
+
+std::expected<int, Error> divide_numbers(const int a, const int b) {
+    if (b == 0) {
+        return std::unexpected(Error{COMPARE_ERR_DIVISION, "Division by zero"});
+    }
+    return a / b;
+}
+
+std::expected<int, Error> process_record(const char *source) {
+    auto buffer = read_record(source);
+    if (!buffer) {
+        return std::unexpected(buffer.error());
+    }
+    const char *cursor = buffer->get();
+    const auto a = parse_number(&cursor);
+    if (!a) {
+        return std::unexpected(a.error());
+    }
+    if (*cursor++ != '/') {
+        return std::unexpected(Error{COMPARE_ERR_PARSE, "Expected '/'"});
+    }
+    const auto b = parse_number(&cursor);
+    if (!b) {
+        return std::unexpected(b.error());
+    }
+    return divide_numbers(*a, *b);
+}
+
+} // namespace
+
+extern "C" long compare_expected_run(const char *const *records, const size_t count) {
+    long checksum = 0;
+    for (size_t i = 0; i < count; i++) {
+        const auto value = process_record(records[i]);
+        checksum += value ? *value : value.error().code;
+    }
+    return checksum;
+}
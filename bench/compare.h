@@ -0,0 +1,27 @@
+#ifndef C_RESULT_COMPARE_H
+#define C_RESULT_COMPARE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shared workload of the comparative benchmark, modelled on the divide_numbers and read_file_contents examples of
+// README.md. Each record is "a/b": it is read into a heap buffer (NULL records are "not found"), both numbers are
+// parsed and divided. Run functions return a checksum, so that every implementation provably did the same work.
+#define COMPARE_ERR_NOT_FOUND (-1)
+#define COMPARE_ERR_PARSE (-2)
+#define COMPARE_ERR_DIVISION (-3)
+
+typedef long (*CompareRun)(const char *const *records, size_t count);
+
+#ifdef C_RESULT_COMPARE_EXPECTED
+long compare_expected_run(const char *const *records, size_t count);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_COMPARE_H
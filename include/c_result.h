@@ -1,11 +1,18 @@
 #ifndef C_RESULT_H
 #define C_RESULT_H
 
+#include <errno.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Compiler-specific attributes for warning about unused results
 #if defined(__GNUC__) || defined(__clang__)
 #define WARN_UNUSED_RESULT __attribute__((warn_unused_result))
@@ -13,6 +20,166 @@
 #define WARN_UNUSED_RESULT
 #endif
 
+// Compiler-specific attributes for checking printf-style format strings
+#if defined(__GNUC__) || defined(__clang__)
+#define PRINTF_FORMAT(format_index, args_index) __attribute__((format(printf, format_index, args_index)))
+#else
+#define PRINTF_FORMAT(format_index, args_index)
+#endif
+
+// Memory allocation used for all Result-owned memory. Define before including this header to override.
+#ifndef C_RESULT_MALLOC
+#define C_RESULT_MALLOC(size) malloc(size)
+#endif
+#ifndef C_RESULT_REALLOC
+#define C_RESULT_REALLOC(ptr, size) realloc(ptr, size)
+#endif
+#ifndef C_RESULT_FREE
+#define C_RESULT_FREE(ptr) free(ptr)
+#endif
+
+// Header-only by default. Define C_RESULT_EXTERN to link against the compiled c_result_static or c_result_shared
+// target instead: the cold paths (error construction, freeing, registration) are then only declared here and
+// defined once, in the translation unit that defines C_RESULT_IMPLEMENTATION. Trivial functions stay inline.
+#if defined(_WIN32) && defined(C_RESULT_SHARED)
+#ifdef C_RESULT_IMPLEMENTATION
+#define C_RESULT_VISIBILITY __declspec(dllexport)
+#else
+#define C_RESULT_VISIBILITY __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+#define C_RESULT_VISIBILITY __attribute__((visibility("default")))
+#else
+#define C_RESULT_VISIBILITY
+#endif
+
+#if defined(C_RESULT_IMPLEMENTATION)
+#define C_RESULT_API C_RESULT_VISIBILITY
+#define C_RESULT_DEFINITIONS
+#elif defined(C_RESULT_EXTERN)
+#define C_RESULT_API extern C_RESULT_VISIBILITY
+#else
+#define C_RESULT_API static inline
+#define C_RESULT_DEFINITIONS
+#endif
+
+// Zero initializer of a struct, without missing-field warnings in C++
+#ifdef __cplusplus
+#define C_RESULT_INIT {}
+#else
+#define C_RESULT_INIT {0}
+#endif
+
+// Variables shared by every translation unit that includes this header, zero-initialized with C_RESULT_ZERO
+#if defined(C_RESULT_IMPLEMENTATION)
+#define C_RESULT_GLOBAL C_RESULT_VISIBILITY
+#define C_RESULT_ZERO = C_RESULT_INIT
+#elif defined(C_RESULT_EXTERN)
+#define C_RESULT_GLOBAL extern C_RESULT_VISIBILITY
+#define C_RESULT_ZERO
+#elif defined(_MSC_VER)
+#define C_RESULT_GLOBAL __declspec(selectany)
+#define C_RESULT_ZERO = C_RESULT_INIT
+#elif defined(__GNUC__) || defined(__clang__)
+#define C_RESULT_GLOBAL __attribute__((weak))
+#define C_RESULT_ZERO = C_RESULT_INIT
+#else
+#define C_RESULT_GLOBAL static // Fallback: one copy per translation unit
+#define C_RESULT_ZERO = C_RESULT_INIT
+#endif
+
+// Thread-local storage
+#if defined(__cplusplus)
+#define C_RESULT_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define C_RESULT_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define C_RESULT_THREAD_LOCAL __declspec(thread)
+#else
+#define C_RESULT_THREAD_LOCAL __thread
+#endif
+
+// Atomic operations: C11 <stdatomic.h> where available, GNU builtins otherwise.
+// Without either, C_RESULT_NO_ATOMICS is defined and the operations are plain, single-threaded ones.
+#if !defined(__cplusplus) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define C_RESULT_ATOMIC(type) _Atomic(type)
+#define C_RESULT_RELAXED memory_order_relaxed
+#define C_RESULT_ACQUIRE memory_order_acquire
+#define C_RESULT_RELEASE memory_order_release
+#define C_RESULT_ACQ_REL memory_order_acq_rel
+#define C_RESULT_SEQ_CST memory_order_seq_cst
+#define c_result_atomic_init(ptr, value) atomic_init(ptr, value)
+#define c_result_atomic_load(ptr, order) atomic_load_explicit(ptr, order)
+#define c_result_atomic_store(ptr, value, order) atomic_store_explicit(ptr, value, order)
+#define c_result_atomic_fetch_add(ptr, value, order) atomic_fetch_add_explicit(ptr, value, order)
+#define c_result_atomic_fetch_sub(ptr, value, order) atomic_fetch_sub_explicit(ptr, value, order)
+#define c_result_atomic_fetch_or(ptr, value, order) atomic_fetch_or_explicit(ptr, value, order)
+#define c_result_atomic_compare_exchange(ptr, expected, desired, order) \
+    atomic_compare_exchange_weak_explicit(ptr, expected, desired, order, C_RESULT_RELAXED)
+#elif defined(__GNUC__) || defined(__clang__)
+#define C_RESULT_ATOMIC(type) type
+#define C_RESULT_RELAXED __ATOMIC_RELAXED
+#define C_RESULT_ACQUIRE __ATOMIC_ACQUIRE
+#define C_RESULT_RELEASE __ATOMIC_RELEASE
+#define C_RESULT_ACQ_REL __ATOMIC_ACQ_REL
+#define C_RESULT_SEQ_CST __ATOMIC_SEQ_CST
+#define c_result_atomic_init(ptr, value) (*(ptr) = (value))
+#define c_result_atomic_load(ptr, order) __atomic_load_n(ptr, order)
+#define c_result_atomic_store(ptr, value, order) __atomic_store_n(ptr, value, order)
+#define c_result_atomic_fetch_add(ptr, value, order) __atomic_fetch_add(ptr, value, order)
+#define c_result_atomic_fetch_sub(ptr, value, order) __atomic_fetch_sub(ptr, value, order)
+#define c_result_atomic_fetch_or(ptr, value, order) __atomic_fetch_or(ptr, value, order)
+#define c_result_atomic_compare_exchange(ptr, expected, desired, order) \
+    __atomic_compare_exchange_n(ptr, expected, desired, true, order, C_RESULT_RELAXED)
+#else
+#define C_RESULT_NO_ATOMICS
+#define C_RESULT_ATOMIC(type) type
+#define C_RESULT_RELAXED 0
+#define C_RESULT_ACQUIRE 0
+#define C_RESULT_RELEASE 0
+#define C_RESULT_ACQ_REL 0
+#define C_RESULT_SEQ_CST 0
+#define c_result_atomic_init(ptr, value) (*(ptr) = (value))
+#define c_result_atomic_load(ptr, order) (*(ptr))
+#define c_result_atomic_store(ptr, value, order) (*(ptr) = (value))
+#define c_result_atomic_fetch_add(ptr, value, order) ((*(ptr) += (value)) - (value))
+#define c_result_atomic_fetch_sub(ptr, value, order) ((*(ptr) -= (value)) + (value))
+#define c_result_atomic_fetch_or(ptr, value, order) c_result_fetch_or_plain(ptr, value)
+#define c_result_atomic_compare_exchange(ptr, expected, desired, order) \
+    (*(ptr) == *(expected) ? (*(ptr) = (desired), true) : (*(expected) = *(ptr), false))
+
+static inline uint32_t c_result_fetch_or_plain(uint32_t *ptr, const uint32_t value) {
+    const uint32_t old = *ptr;
+    *ptr = old | value;
+    return old;
+}
+#endif
+
+// Compile-time assertions
+#if defined(__cplusplus)
+#define C_RESULT_STATIC_ASSERT(condition, message) static_assert(condition, message)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define C_RESULT_STATIC_ASSERT(condition, message) _Static_assert(condition, message)
+#else
+#define C_RESULT_CONCAT_(a, b) a##b
+#define C_RESULT_CONCAT(a, b) C_RESULT_CONCAT_(a, b)
+#define C_RESULT_STATIC_ASSERT(condition, message) \
+    typedef char C_RESULT_CONCAT(c_result_static_assert_, __LINE__)[(condition) ? 1 : -1]
+#endif
+
+// Capacity of the inline message buffer used by make_errorf(), including the terminator.
+// Longer messages fall back to the heap. The default fits the 16-byte payload union, so a Result stays 32 bytes,
+// or the 8-byte payload word with C_RESULT_COMPACT. Define it larger (e.g. 48) to keep longer messages inline at the
+// cost of a larger Result; the define must then be the same in every translation unit.
+#ifndef C_RESULT_INLINE_MESSAGE_SIZE
+#ifdef C_RESULT_COMPACT
+#define C_RESULT_INLINE_MESSAGE_SIZE 8
+#else
+#define C_RESULT_INLINE_MESSAGE_SIZE 16
+#endif
+#endif
+
 typedef int ResultCode;
 
 // Core Error codes (reserved range: 0-(-999))
@@ -50,10 +217,113 @@ typedef int ResultCode;
 #define ERR_MATH_DOMAIN (-31)
 #define ERR_ILLEGAL_SEQUENCE (-32)
 #define ERR_UNKNOWN (-33)
+#define ERR_END_OF_STREAM (-34)
+
+// Last core code, bounds the core tables
+#define C_RESULT_LAST_CORE_CODE ERR_END_OF_STREAM
 
 // App-defined result codes should start at -1000
 #define APP_RESULT_CODE_START (-1000)
 
+// Name and description of a result code
+typedef struct {
+    const char *name;
+    const char *description;
+} ResultCodeInfo;
+
+// Core codes, indexed by -code
+static const ResultCodeInfo c_result_core_codes[-C_RESULT_LAST_CORE_CODE + 1] = {
+    {"SUCCESS", "Success"},
+    {"ERR_INVALID_INPUT", "Invalid input"},
+    {"ERR_OUT_OF_MEMORY", "Out of memory"},
+    {"ERR_FILE_IO", "File I/O error"},
+    {"ERR_NULL_POINTER", "Null pointer"},
+    {"ERR_BUFFER_OVERFLOW", "Buffer overflow"},
+    {"ERR_FILE_NOT_FOUND", "File not found"},
+    {"ERR_PERMISSION_DENIED", "Permission denied"},
+    {"ERR_NOT_IMPLEMENTED", "Not implemented"},
+    {"ERR_TIMEOUT", "Timed out"},
+    {"ERR_RESOURCE_BUSY", "Resource busy"},
+    {"ERR_INVALID_STATE", "Invalid state"},
+    {"ERR_OUT_OF_RANGE", "Out of range"},
+    {"ERR_BAD_FORMAT", "Bad format"},
+    {"ERR_NO_SPACE", "No space left"},
+    {"ERR_ALREADY_EXISTS", "Already exists"},
+    {"ERR_NOT_FOUND", "Not found"},
+    {"ERR_INVALID_OPERATION", "Invalid operation"},
+    {"ERR_NETWORK_ERROR", "Network error"},
+    {"ERR_CONNECTION_FAILED", "Connection failed"},
+    {"ERR_INTERRUPTED", "Interrupted"},
+    {"ERR_DEVICE_ERROR", "Device error"},
+    {"ERR_PROTOCOL_ERROR", "Protocol error"},
+    {"ERR_INVALID_CONFIG", "Invalid configuration"},
+    {"ERR_LOCK_FAILED", "Lock failed"},
+    {"ERR_TOO_MANY_OPEN_FILES", "Too many open files"},
+    {"ERR_INVALID_PATH", "Invalid path"},
+    {"ERR_READ_ONLY", "Read-only"},
+    {"ERR_NOT_A_DIRECTORY", "Not a directory"},
+    {"ERR_DIRECTORY_NOT_EMPTY", "Directory not empty"},
+    {"ERR_BROKEN_PIPE", "Broken pipe"},
+    {"ERR_MATH_DOMAIN", "Math domain error"},
+    {"ERR_ILLEGAL_SEQUENCE", "Illegal byte sequence"},
+    {"ERR_UNKNOWN", "Unknown error"},
+    {"ERR_END_OF_STREAM", "End of stream"}
+};
+
+// Capacity of the table of application codes, which are indexed by APP_RESULT_CODE_START - code
+#ifndef C_RESULT_MAX_APP_CODES
+#define C_RESULT_MAX_APP_CODES 256
+#endif
+
+C_RESULT_GLOBAL ResultCodeInfo c_result_app_codes[C_RESULT_MAX_APP_CODES] C_RESULT_ZERO;
+
+static const ResultCodeInfo c_result_unknown_code = {"UNKNOWN_RESULT_CODE", "Unknown result code"};
+
+// Name and description lookup, a single load from one of the two dense tables
+static inline const ResultCodeInfo *result_code_info(const ResultCode code) {
+    if (code <= SUCCESS && code >= C_RESULT_LAST_CORE_CODE) {
+        return &c_result_core_codes[-code];
+    }
+    if (code <= APP_RESULT_CODE_START && code > APP_RESULT_CODE_START - C_RESULT_MAX_APP_CODES &&
+        c_result_app_codes[APP_RESULT_CODE_START - code].name) {
+        return &c_result_app_codes[APP_RESULT_CODE_START - code];
+    }
+    return &c_result_unknown_code;
+}
+
+// Helper function to get the name of a code, e.g. "ERR_TIMEOUT"
+static inline const char *result_code_name(const ResultCode code) {
+    return result_code_info(code)->name;
+}
+
+// Helper function to get the description of a code, e.g. "Timed out"
+static inline const char *result_code_description(const ResultCode code) {
+    return result_code_info(code)->description;
+}
+
+// Application code registration, meant to happen once at startup. The strings are borrowed, not copied.
+// Returns SUCCESS, ERR_OUT_OF_RANGE for codes outside the application range or table, or ERR_ALREADY_EXISTS.
+C_RESULT_API ResultCode result_register_code(const ResultCode code, const char *name, const char *description)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!name || !description) {
+        return ERR_NULL_POINTER;
+    }
+    if (code > APP_RESULT_CODE_START || code <= APP_RESULT_CODE_START - C_RESULT_MAX_APP_CODES) {
+        return ERR_OUT_OF_RANGE;
+    }
+    ResultCodeInfo *info = &c_result_app_codes[APP_RESULT_CODE_START - code];
+    if (info->name) {
+        return ERR_ALREADY_EXISTS;
+    }
+    info->name = name;
+    info->description = description;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
 // Type tags for the value union
 typedef enum {
     RESULT_TYPE_NONE, // Error result
@@ -80,244 +350,1108 @@ typedef enum {
     RESULT_TYPE_CUSTOM // For user-defined types
 } ResultValueType;
 
+// Storage class of an error message
+typedef enum {
+    RESULT_MESSAGE_NONE, // No message attached
+    RESULT_MESSAGE_HEAP, // Heap copy owned by the Result
+    RESULT_MESSAGE_STATIC, // Borrowed string with static storage duration, never freed
+    RESULT_MESSAGE_INLINE, // Stored in data.inline_message, inside the Result itself
+    RESULT_MESSAGE_ARENA, // Copied into the thread arena, reclaimed by c_result_thread_arena_reset()
+    RESULT_MESSAGE_LOCATION, // Borrowed static ResultLocation, see make_error_here() in c_result_trace.h
+    RESULT_MESSAGE_ERRNO, // errno value in data.os_error, see make_error_from_errno()
+    RESULT_MESSAGE_WIN32, // Win32 error code in data.os_error, see make_error_from_win32()
+    RESULT_MESSAGE_CONTEXT // Chain of context frames in data.context, owned by the Result, see result_wrap()
+} ResultMessageStorage;
+
+// Source location of an error, with static storage duration
+typedef struct {
+    const char *file;
+    const char *function;
+    int line;
+    const char *message;
+} ResultLocation;
+
+// Result flag bits. The upper four bits hold the id of the allocator owning the memory, see ResultAllocator.
+#define RESULT_FLAG_CUSTOM_BOXED 0x01 // Custom payload and destructor live out of line (C_RESULT_COMPACT)
+#define RESULT_FLAG_SHARED 0x02 // String or custom payload is reference counted, see make_success_shared()
+#define RESULT_FLAG_ALLOCATOR_SHIFT 4
+#define RESULT_FLAG_ALLOCATOR_MASK 0xF0
+
 // Custom type destructor function signature
 typedef void (*CustomDestructor)(void *);
 
+// Custom type data
+typedef struct {
+    void *data;
+    CustomDestructor destructor;
+} ResultCustom;
+
+// Reference-counted payload shared by several results
+typedef struct {
+    ResultCustom custom;
+    C_RESULT_ATOMIC(size_t) references;
+} ResultShared;
+
+// Frame of an error context chain, see result_wrap()
+typedef struct ResultContextFrame ResultContextFrame;
+
+// With C_RESULT_COMPACT, the tag, code and ownership are packed into one 8-byte word and the custom
+// destructor is moved out of line, so a Result is 16 bytes and is returned in registers (RAX:RDX on x86-64 SysV).
 typedef struct {
     ResultCode code;
+#ifdef C_RESULT_COMPACT
+    uint8_t value_type; // ResultValueType
+#else
     ResultValueType value_type;
+#endif
     bool owns_memory; // Indicates if Result owns allocated memory
+    uint8_t message_storage; // ResultMessageStorage of data.message
+    uint8_t flags; // RESULT_FLAG_* bits
 
     union {
         // Error data
         char *message;
+        char inline_message[C_RESULT_INLINE_MESSAGE_SIZE];
+        const ResultLocation *location;
+        uint32_t os_error;
+        ResultContextFrame *context;
+
+        // Success values
+        union {
+            void *pointer;
+            char *string;
+            int int_val;
+            long long_val;
+            float float_val;
+            double double_val;
+            bool bool_val;
+            char char_val;
+            short short_val;
+            unsigned int uint_val;
+            unsigned long ulong_val;
+            size_t size_val;
+            int8_t int8_val;
+            uint8_t uint8_val;
+            int16_t int16_val;
+            uint16_t uint16_val;
+            int32_t int32_val;
+            uint32_t uint32_val;
+            int64_t int64_val;
+            uint64_t uint64_val;
+
+            // Shared string or custom data, when RESULT_FLAG_SHARED is set
+            ResultShared *shared;
+
+            // Custom type data
+#ifdef C_RESULT_COMPACT
+            union {
+                void *data; // Payload without destructor
+                ResultCustom *boxed; // Payload with destructor, when RESULT_FLAG_CUSTOM_BOXED is set
+            } custom;
+#else
+            ResultCustom custom;
+#endif
+        } value;
+    } data;
+} Result;
+
+#ifdef C_RESULT_COMPACT
+C_RESULT_STATIC_ASSERT(sizeof(Result) == 16, "C_RESULT_COMPACT Result must be 16 bytes to be returned in registers");
+#endif
+
+// Custom payload pointer, looking through shared payloads and the out-of-line box of compact results
+#ifdef C_RESULT_COMPACT
+#define RESULT_CUSTOM_DATA(result) \
+    (((result).flags & RESULT_FLAG_CUSTOM_BOXED) ? (result).data.value.custom.boxed->data : \
+     ((result).flags & RESULT_FLAG_SHARED) ? (result).data.value.shared->custom.data : (result).data.value.custom.data)
+#else
+#define RESULT_CUSTOM_DATA(result) \
+    (((result).flags & RESULT_FLAG_SHARED) ? (result).data.value.shared->custom.data : (result).data.value.custom.data)
+#endif
+
+// String payload pointer, looking through shared payloads
+#define RESULT_STRING_DATA(result) \
+    (((result).flags & RESULT_FLAG_SHARED) ? (char *) (result).data.value.shared->custom.data : (result).data.value.string)
+
+// Pluggable allocator for messages and owned payloads, e.g. a per-request arena.
+// Allocators are registered once under a small id (1-15) stored in the flags of each Result using them;
+// id 0 (RESULT_ALLOCATOR_DEFAULT) is C_RESULT_MALLOC/C_RESULT_FREE.
+typedef struct {
+    void *(*allocate)(void *context, size_t size);
+    void (*release)(void *context, void *ptr); // NULL for arenas released in bulk: free_result() does nothing
+    void *context;
+} ResultAllocator;
+
+#define RESULT_ALLOCATOR_DEFAULT 0
+#define C_RESULT_MAX_ALLOCATORS 16
+
+C_RESULT_GLOBAL const ResultAllocator *c_result_allocators[C_RESULT_MAX_ALLOCATORS] C_RESULT_ZERO;
+
+static inline void *c_result_allocate(const uint8_t allocator, const size_t size) {
+    if (allocator == RESULT_ALLOCATOR_DEFAULT) {
+        return C_RESULT_MALLOC(size);
+    }
+    const ResultAllocator *registered = allocator < C_RESULT_MAX_ALLOCATORS ? c_result_allocators[allocator] : NULL;
+    return registered ? registered->allocate(registered->context, size) : NULL;
+}
+
+static inline void c_result_release(const uint8_t allocator, void *ptr) {
+    if (allocator == RESULT_ALLOCATOR_DEFAULT) {
+        C_RESULT_FREE(ptr);
+        return;
+    }
+    const ResultAllocator *registered = allocator < C_RESULT_MAX_ALLOCATORS ? c_result_allocators[allocator] : NULL;
+    if (registered && registered->release) {
+        registered->release(registered->context, ptr);
+    }
+}
+
+// Helper function to get the id of the allocator owning the memory of a result
+static inline uint8_t result_allocator(const Result *result) {
+    return (uint8_t) ((result->flags & RESULT_FLAG_ALLOCATOR_MASK) >> RESULT_FLAG_ALLOCATOR_SHIFT);
+}
+
+// Helper function to tag the memory owned by a result as coming from a registered allocator,
+// so that free_result() gives it back there. Use it on owned pointer, string and custom (without destructor) results.
+static inline void result_set_allocator(Result *result, const uint8_t allocator) {
+    result->flags = (uint8_t) ((result->flags & ~RESULT_FLAG_ALLOCATOR_MASK) |
+                               ((allocator << RESULT_FLAG_ALLOCATOR_SHIFT) & RESULT_FLAG_ALLOCATOR_MASK));
+}
+
+// Thread-local bump arena for error message text.
+// Once initialized on a thread, make_error() and make_errorf() copy messages into the arena instead of the heap,
+// free_result() does nothing for them, and c_result_thread_arena_reset() reclaims them all at once,
+// e.g. at the end of an event loop tick. Messages that do not fit fall back to the heap.
+typedef struct {
+    char *buffer;
+    size_t capacity;
+    size_t used;
+} ResultThreadArena;
+
+#define C_RESULT_ARENA_ALIGNMENT (2 * sizeof(void *))
+
+C_RESULT_GLOBAL C_RESULT_THREAD_LOCAL ResultThreadArena c_result_thread_arena C_RESULT_ZERO;
+
+// Arena initialization for the calling thread, returns SUCCESS or ERR_OUT_OF_MEMORY.
+// Returns ERR_INVALID_STATE if the thread already has an arena, whose messages may still be in use:
+// call c_result_thread_arena_destroy() first to resize it.
+C_RESULT_API ResultCode c_result_thread_arena_init(const size_t capacity)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (c_result_thread_arena.buffer) {
+        return ERR_INVALID_STATE;
+    }
+    char *buffer = (char *) C_RESULT_MALLOC(capacity);
+    if (!buffer) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    c_result_thread_arena.buffer = buffer;
+    c_result_thread_arena.capacity = capacity;
+    c_result_thread_arena.used = 0;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Reclaims every message of the calling thread's arena. Results using them must not be read afterwards.
+static inline void c_result_thread_arena_reset(void) {
+    c_result_thread_arena.used = 0;
+}
+
+// Releases the calling thread's arena, error messages go back to the heap
+C_RESULT_API void c_result_thread_arena_destroy(void)
+#ifdef C_RESULT_DEFINITIONS
+{
+    C_RESULT_FREE(c_result_thread_arena.buffer);
+    c_result_thread_arena.buffer = NULL;
+    c_result_thread_arena.capacity = 0;
+    c_result_thread_arena.used = 0;
+}
+#else
+;
+#endif
+
+// Allocation from the calling thread's arena, NULL if it is not initialized or full
+static inline void *c_result_thread_arena_allocate(void *context, const size_t size) {
+    (void) context;
+    const size_t offset = (c_result_thread_arena.used + C_RESULT_ARENA_ALIGNMENT - 1) & ~(C_RESULT_ARENA_ALIGNMENT - 1);
+    if (!c_result_thread_arena.buffer || offset > c_result_thread_arena.capacity ||
+        size > c_result_thread_arena.capacity - offset) {
+        return NULL;
+    }
+    c_result_thread_arena.used = offset + size;
+    return c_result_thread_arena.buffer + offset;
+}
+
+// The thread arena as a ResultAllocator, to register it for owned payloads as well
+static inline ResultAllocator c_result_thread_arena_allocator(void) {
+    ResultAllocator allocator = {c_result_thread_arena_allocate, NULL, NULL};
+    return allocator;
+}
+
+// Instrumentation counters, enabled with C_RESULT_STATS.
+// Each thread counts into its own cache-line-padded block, which it pushes onto a global lock-free list on first use.
+// Only the owning thread writes a block, with relaxed atomic stores: counting adds no contention and no locked
+// instructions, and c_result_stats_snapshot() sums all blocks without locks. Blocks are never freed, so the counts of
+// exited threads are kept.
+#define C_RESULT_STATS_VALUE_TYPES (RESULT_TYPE_CUSTOM + 1)
+// Core codes, app codes, other codes
+#define C_RESULT_STATS_CODES (-C_RESULT_LAST_CORE_CODE + 1 + C_RESULT_MAX_APP_CODES + 1)
+
+typedef struct {
+    uint64_t created[C_RESULT_STATS_VALUE_TYPES]; // Results created per ResultValueType, errors are RESULT_TYPE_NONE
+    uint64_t errors[C_RESULT_STATS_CODES]; // Errors created per code, index with c_result_stats_code_index()
+    uint64_t message_bytes; // Bytes allocated for error messages, on the heap or in the thread arena
+    uint64_t payload_bytes; // Bytes allocated by the library for payloads: compact boxes, shared blocks, clones
+    uint64_t frees; // free_result() calls that released memory owned by the result
+    size_t threads; // Number of threads that have counted
+} ResultStats;
+
+// Index of a code in ResultStats.errors
+static inline size_t c_result_stats_code_index(const ResultCode code) {
+    if (code <= SUCCESS && code >= C_RESULT_LAST_CORE_CODE) {
+        return (size_t) -code;
+    }
+    if (code <= APP_RESULT_CODE_START && code > APP_RESULT_CODE_START - C_RESULT_MAX_APP_CODES) {
+        return (size_t) (-C_RESULT_LAST_CORE_CODE + 1 + (APP_RESULT_CODE_START - code));
+    }
+    return C_RESULT_STATS_CODES - 1;
+}
+
+#ifdef C_RESULT_STATS
+#define C_RESULT_STATS_MESSAGE_BYTES (C_RESULT_STATS_VALUE_TYPES + C_RESULT_STATS_CODES)
+#define C_RESULT_STATS_PAYLOAD_BYTES (C_RESULT_STATS_MESSAGE_BYTES + 1)
+#define C_RESULT_STATS_FREES (C_RESULT_STATS_MESSAGE_BYTES + 2)
+#define C_RESULT_STATS_COUNTERS (C_RESULT_STATS_MESSAGE_BYTES + 3)
+#define C_RESULT_CACHE_LINE 64
+
+typedef struct ResultStatsBlock {
+    C_RESULT_ATOMIC(uint64_t) counters[C_RESULT_STATS_COUNTERS]; // created, errors, then the byte and free counters
+    struct ResultStatsBlock *next;
+    char padding[C_RESULT_CACHE_LINE -
+                 (C_RESULT_STATS_COUNTERS * sizeof(uint64_t) + sizeof(void *)) % C_RESULT_CACHE_LINE];
+} ResultStatsBlock;
+
+C_RESULT_GLOBAL C_RESULT_ATOMIC(ResultStatsBlock *) c_result_stats_blocks C_RESULT_ZERO;
+C_RESULT_GLOBAL C_RESULT_THREAD_LOCAL ResultStatsBlock *c_result_stats_block C_RESULT_ZERO;
+
+// Allocates and publishes the block of the calling thread, NULL when out of memory (the event is not counted)
+C_RESULT_API ResultStatsBlock *c_result_stats_register(void)
+#ifdef C_RESULT_DEFINITIONS
+{
+    char *memory = (char *) C_RESULT_MALLOC(sizeof(ResultStatsBlock) + C_RESULT_CACHE_LINE - 1);
+    if (!memory) {
+        return NULL;
+    }
+    // Aligned to a cache line, so that no two threads write the same line. The block is never freed.
+    ResultStatsBlock *block =
+        (ResultStatsBlock *) (((uintptr_t) memory + C_RESULT_CACHE_LINE - 1) & ~(uintptr_t) (C_RESULT_CACHE_LINE - 1));
+    for (size_t i = 0; i < C_RESULT_STATS_COUNTERS; i++) {
+        c_result_atomic_init(&block->counters[i], 0);
+    }
+    block->next = c_result_atomic_load(&c_result_stats_blocks, C_RESULT_RELAXED);
+    while (!c_result_atomic_compare_exchange(&c_result_stats_blocks, &block->next, block, C_RESULT_RELEASE)) {
+    }
+    c_result_stats_block = block;
+    return block;
+}
+#else
+;
+#endif
+
+static inline void c_result_stats_count(const size_t counter, const uint64_t amount) {
+    ResultStatsBlock *block = c_result_stats_block ? c_result_stats_block : c_result_stats_register();
+    if (block) {
+        // Single writer: a relaxed load and store instead of a locked read-modify-write
+        c_result_atomic_store(&block->counters[counter],
+                              c_result_atomic_load(&block->counters[counter], C_RESULT_RELAXED) + amount,
+                              C_RESULT_RELAXED);
+    }
+}
+
+// Sums the counters of all threads. Counts are read while other threads keep counting, so they are not a
+// consistent cut and each counter is only exact once the threads are quiescent.
+static inline void c_result_stats_snapshot(ResultStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (const ResultStatsBlock *block = c_result_atomic_load(&c_result_stats_blocks, C_RESULT_ACQUIRE); block;
+         block = block->next) {
+        for (size_t i = 0; i < C_RESULT_STATS_VALUE_TYPES; i++) {
+            stats->created[i] += c_result_atomic_load(&block->counters[i], C_RESULT_RELAXED);
+        }
+        for (size_t i = 0; i < C_RESULT_STATS_CODES; i++) {
+            stats->errors[i] += c_result_atomic_load(&block->counters[C_RESULT_STATS_VALUE_TYPES + i], C_RESULT_RELAXED);
+        }
+        stats->message_bytes += c_result_atomic_load(&block->counters[C_RESULT_STATS_MESSAGE_BYTES], C_RESULT_RELAXED);
+        stats->payload_bytes += c_result_atomic_load(&block->counters[C_RESULT_STATS_PAYLOAD_BYTES], C_RESULT_RELAXED);
+        stats->frees += c_result_atomic_load(&block->counters[C_RESULT_STATS_FREES], C_RESULT_RELAXED);
+        stats->threads++;
+    }
+}
+
+#define C_RESULT_STATS_CREATED(value_type) c_result_stats_count((size_t) (value_type), 1)
+#define C_RESULT_STATS_ERROR(code) \
+    (c_result_stats_count(RESULT_TYPE_NONE, 1), \
+     c_result_stats_count(C_RESULT_STATS_VALUE_TYPES + c_result_stats_code_index(code), 1))
+#define C_RESULT_STATS_MESSAGE(bytes) c_result_stats_count(C_RESULT_STATS_MESSAGE_BYTES, bytes)
+#define C_RESULT_STATS_PAYLOAD(bytes) c_result_stats_count(C_RESULT_STATS_PAYLOAD_BYTES, bytes)
+#define C_RESULT_STATS_FREE() c_result_stats_count(C_RESULT_STATS_FREES, 1)
+#else
+// Without C_RESULT_STATS, the snapshot is all zeros and counting compiles to nothing
+static inline void c_result_stats_snapshot(ResultStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#define C_RESULT_STATS_CREATED(value_type) ((void) 0)
+#define C_RESULT_STATS_ERROR(code) ((void) 0)
+#define C_RESULT_STATS_MESSAGE(bytes) ((void) 0)
+#define C_RESULT_STATS_PAYLOAD(bytes) ((void) 0)
+#define C_RESULT_STATS_FREE() ((void) 0)
+#endif
+
+// Error context chains, built by result_wrap() as an error propagates up through the layers of a program.
+// Each frame is a fixed-size node holding one context text: the newest frame comes first, the oldest one holds the
+// wrapped error. Adding context copies only the new text, never the message below it, and frames come from a
+// per-thread free list, so once the pool is warm wrapping does not allocate. result_format_chain() renders the
+// chain only when it is actually logged.
+
+// Capacity of the text of one frame, including the terminator. Longer context texts are truncated.
+#ifndef C_RESULT_CONTEXT_SIZE
+#define C_RESULT_CONTEXT_SIZE 64
+#endif
+
+// Number of free frames each thread keeps for reuse, frames freed beyond that go back to the heap
+#ifndef C_RESULT_CONTEXT_POOL_SIZE
+#define C_RESULT_CONTEXT_POOL_SIZE 64
+#endif
+
+struct ResultContextFrame {
+    ResultContextFrame *next; // Older frame, NULL for the oldest one
+    Result cause; // The wrapped error, in the oldest frame only
+    char text[C_RESULT_CONTEXT_SIZE];
+};
+
+typedef struct {
+    ResultContextFrame *free;
+    size_t count;
+} ResultContextPool;
+
+C_RESULT_GLOBAL C_RESULT_THREAD_LOCAL ResultContextPool c_result_context_pool C_RESULT_ZERO;
+
+// Frame from the calling thread's pool, or from the heap when the pool is empty. NULL when out of memory.
+static inline ResultContextFrame *c_result_context_acquire(void) {
+    ResultContextFrame *frame = c_result_context_pool.free;
+    if (frame) {
+        c_result_context_pool.free = frame->next;
+        c_result_context_pool.count--;
+        return frame;
+    }
+    frame = (ResultContextFrame *) C_RESULT_MALLOC(sizeof(ResultContextFrame));
+    if (frame) {
+        C_RESULT_STATS_MESSAGE(sizeof(ResultContextFrame));
+    }
+    return frame;
+}
+
+// Gives a frame back to the pool of the calling thread, whichever thread acquired it
+static inline void c_result_context_release(ResultContextFrame *frame) {
+    if (c_result_context_pool.count >= C_RESULT_CONTEXT_POOL_SIZE) {
+        C_RESULT_FREE(frame);
+        return;
+    }
+    frame->next = c_result_context_pool.free;
+    c_result_context_pool.free = frame;
+    c_result_context_pool.count++;
+}
+
+// Frees the free frames of the calling thread's pool, e.g. before the thread exits
+C_RESULT_API void c_result_context_pool_drain(void)
+#ifdef C_RESULT_DEFINITIONS
+{
+    while (c_result_context_pool.free) {
+        ResultContextFrame *next = c_result_context_pool.free->next;
+        C_RESULT_FREE(c_result_context_pool.free);
+        c_result_context_pool.free = next;
+    }
+    c_result_context_pool.count = 0;
+}
+#else
+;
+#endif
+
+// With C_RESULT_NO_MESSAGES, error creation functions store no text at all: they neither allocate nor
+// measure the message, and result_get_error_message() returns a static description of the code instead.
+static inline Result c_result_error_without_message(const ResultCode code) {
+    Result res = C_RESULT_INIT;
+    res.code = code;
+    res.value_type = RESULT_TYPE_NONE;
+    res.owns_memory = false;
+    C_RESULT_STATS_ERROR(code);
+    return res;
+}
+
+// Error creation with the message copied into memory from a registered allocator
+WARN_UNUSED_RESULT C_RESULT_API Result make_error_with_allocator(const uint8_t allocator, const ResultCode code,
+                                                                  const char *message)
+#ifdef C_RESULT_DEFINITIONS
+{
+#ifdef C_RESULT_NO_MESSAGES
+    (void) allocator;
+    (void) message;
+    return c_result_error_without_message(code);
+#else
+    Result res = C_RESULT_INIT; // Zero-initialize the entire struct
+    res.code = code;
+    res.value_type = RESULT_TYPE_NONE;
+    res.owns_memory = true; // Error messages are always owned by the Result
+    result_set_allocator(&res, allocator);
+
+    if (message) {
+        const size_t size = strlen(message) + 1;
+        res.data.message = (char *) c_result_allocate(allocator, size);
+        if (res.data.message) {
+            memcpy(res.data.message, message, size);
+            res.message_storage = RESULT_MESSAGE_HEAP;
+            C_RESULT_STATS_MESSAGE(size);
+        } else {
+            res.code = ERR_OUT_OF_MEMORY;
+        }
+    }
+    C_RESULT_STATS_ERROR(res.code);
+    return res;
+#endif
+}
+#else
+;
+#endif
+
+// Error creation
+WARN_UNUSED_RESULT C_RESULT_API Result make_error(const ResultCode code, const char *message)
+#ifdef C_RESULT_DEFINITIONS
+{
+#ifdef C_RESULT_NO_MESSAGES
+    (void) message;
+    return c_result_error_without_message(code);
+#else
+    if (message && c_result_thread_arena.buffer) {
+        const size_t size = strlen(message) + 1;
+        char *copy = (char *) c_result_thread_arena_allocate(NULL, size);
+        if (copy) {
+            Result res = C_RESULT_INIT;
+            res.code = code;
+            res.value_type = RESULT_TYPE_NONE;
+            res.owns_memory = false; // The arena owns the message
+            memcpy(copy, message, size);
+            res.data.message = copy;
+            res.message_storage = RESULT_MESSAGE_ARENA;
+            C_RESULT_STATS_MESSAGE(size);
+            C_RESULT_STATS_ERROR(code);
+            return res;
+        }
+    }
+    return make_error_with_allocator(RESULT_ALLOCATOR_DEFAULT, code, message);
+#endif
+}
+#else
+;
+#endif
+
+// Error creation from a string with static storage duration (e.g. a literal).
+// The message is borrowed, not copied: no allocation is made and free_result() never frees it.
+WARN_UNUSED_RESULT static inline Result make_error_static(const ResultCode code, const char *message) {
+#ifdef C_RESULT_NO_MESSAGES
+    (void) message;
+    return c_result_error_without_message(code);
+#else
+    Result res = C_RESULT_INIT;
+    res.code = code;
+    res.value_type = RESULT_TYPE_NONE;
+    res.owns_memory = false;
+    if (message) {
+        res.data.message = (char *) message;
+        res.message_storage = RESULT_MESSAGE_STATIC;
+    }
+    C_RESULT_STATS_ERROR(code);
+    return res;
+#endif
+}
+
+// Error creation from a static source location record, which is borrowed like a static message.
+// Usually called through make_error_here(), which creates the record. The location is kept with
+// C_RESULT_NO_MESSAGES too, only the message of the record is left out.
+WARN_UNUSED_RESULT static inline Result make_error_location(const ResultCode code, const ResultLocation *location) {
+    Result res = C_RESULT_INIT;
+    res.code = code;
+    res.value_type = RESULT_TYPE_NONE;
+    res.owns_memory = false;
+    if (location) {
+        res.data.location = location;
+        res.message_storage = RESULT_MESSAGE_LOCATION;
+    }
+    C_RESULT_STATS_ERROR(code);
+    return res;
+}
+
+// Translation of an OS error into a result code and a static message
+typedef struct {
+    ResultCode code;
+#ifndef C_RESULT_NO_MESSAGES
+    const char *message;
+#endif
+} ResultOsError;
+
+static inline ResultOsError c_result_os_error(const ResultCode code, const char *message) {
+    ResultOsError error;
+    error.code = code;
+#ifdef C_RESULT_NO_MESSAGES
+    (void) message;
+#else
+    error.message = message;
+#endif
+    return error;
+}
+
+// Case of the lookup switches below, which compilers compile to a jump table or a range check and table load
+#define C_RESULT_OS_ERROR(os_error, code, message) \
+    case os_error: \
+        return c_result_os_error(code, message);
+
+#define C_RESULT_OS_ERROR_UNKNOWN c_result_os_error(ERR_UNKNOWN, "Unknown system error")
+
+// errno values this platform defines
+static inline ResultOsError c_result_errno_lookup(const int error) {
+    switch (error) {
+        C_RESULT_OS_ERROR(EDOM, ERR_MATH_DOMAIN, "Numerical argument out of domain")
+        C_RESULT_OS_ERROR(ERANGE, ERR_OUT_OF_RANGE, "Numerical result out of range")
+        C_RESULT_OS_ERROR(EILSEQ, ERR_ILLEGAL_SEQUENCE, "Invalid or incomplete multibyte or wide character")
+#ifdef EPERM
+        C_RESULT_OS_ERROR(EPERM, ERR_PERMISSION_DENIED, "Operation not permitted")
+#endif
+#ifdef ENOENT
+        C_RESULT_OS_ERROR(ENOENT, ERR_FILE_NOT_FOUND, "No such file or directory")
+#endif
+#ifdef ESRCH
+        C_RESULT_OS_ERROR(ESRCH, ERR_NOT_FOUND, "No such process")
+#endif
+#ifdef EINTR
+        C_RESULT_OS_ERROR(EINTR, ERR_INTERRUPTED, "Interrupted system call")
+#endif
+#ifdef EIO
+        C_RESULT_OS_ERROR(EIO, ERR_FILE_IO, "Input/output error")
+#endif
+#ifdef ENXIO
+        C_RESULT_OS_ERROR(ENXIO, ERR_DEVICE_ERROR, "No such device or address")
+#endif
+#ifdef E2BIG
+        C_RESULT_OS_ERROR(E2BIG, ERR_INVALID_INPUT, "Argument list too long")
+#endif
+#ifdef ENOEXEC
+        C_RESULT_OS_ERROR(ENOEXEC, ERR_BAD_FORMAT, "Exec format error")
+#endif
+#ifdef EBADF
+        C_RESULT_OS_ERROR(EBADF, ERR_INVALID_INPUT, "Bad file descriptor")
+#endif
+#ifdef ECHILD
+        C_RESULT_OS_ERROR(ECHILD, ERR_NOT_FOUND, "No child processes")
+#endif
+#ifdef EAGAIN
+        C_RESULT_OS_ERROR(EAGAIN, ERR_RESOURCE_BUSY, "Resource temporarily unavailable")
+#endif
+#ifdef ENOMEM
+        C_RESULT_OS_ERROR(ENOMEM, ERR_OUT_OF_MEMORY, "Cannot allocate memory")
+#endif
+#ifdef EACCES
+        C_RESULT_OS_ERROR(EACCES, ERR_PERMISSION_DENIED, "Permission denied")
+#endif
+#ifdef EFAULT
+        C_RESULT_OS_ERROR(EFAULT, ERR_INVALID_INPUT, "Bad address")
+#endif
+#ifdef EBUSY
+        C_RESULT_OS_ERROR(EBUSY, ERR_RESOURCE_BUSY, "Device or resource busy")
+#endif
+#ifdef EEXIST
+        C_RESULT_OS_ERROR(EEXIST, ERR_ALREADY_EXISTS, "File exists")
+#endif
+#ifdef EXDEV
+        C_RESULT_OS_ERROR(EXDEV, ERR_INVALID_OPERATION, "Invalid cross-device link")
+#endif
+#ifdef ENODEV
+        C_RESULT_OS_ERROR(ENODEV, ERR_DEVICE_ERROR, "No such device")
+#endif
+#ifdef ENOTDIR
+        C_RESULT_OS_ERROR(ENOTDIR, ERR_NOT_A_DIRECTORY, "Not a directory")
+#endif
+#ifdef EISDIR
+        C_RESULT_OS_ERROR(EISDIR, ERR_INVALID_PATH, "Is a directory")
+#endif
+#ifdef EINVAL
+        C_RESULT_OS_ERROR(EINVAL, ERR_INVALID_INPUT, "Invalid argument")
+#endif
+#ifdef ENFILE
+        C_RESULT_OS_ERROR(ENFILE, ERR_TOO_MANY_OPEN_FILES, "Too many open files in system")
+#endif
+#ifdef EMFILE
+        C_RESULT_OS_ERROR(EMFILE, ERR_TOO_MANY_OPEN_FILES, "Too many open files")
+#endif
+#ifdef ENOTTY
+        C_RESULT_OS_ERROR(ENOTTY, ERR_INVALID_OPERATION, "Inappropriate ioctl for device")
+#endif
+#ifdef ETXTBSY
+        C_RESULT_OS_ERROR(ETXTBSY, ERR_RESOURCE_BUSY, "Text file busy")
+#endif
+#ifdef EFBIG
+        C_RESULT_OS_ERROR(EFBIG, ERR_OUT_OF_RANGE, "File too large")
+#endif
+#ifdef ENOSPC
+        C_RESULT_OS_ERROR(ENOSPC, ERR_NO_SPACE, "No space left on device")
+#endif
+#ifdef ESPIPE
+        C_RESULT_OS_ERROR(ESPIPE, ERR_INVALID_OPERATION, "Illegal seek")
+#endif
+#ifdef EROFS
+        C_RESULT_OS_ERROR(EROFS, ERR_READ_ONLY, "Read-only file system")
+#endif
+#ifdef EMLINK
+        C_RESULT_OS_ERROR(EMLINK, ERR_OUT_OF_RANGE, "Too many links")
+#endif
+#ifdef EPIPE
+        C_RESULT_OS_ERROR(EPIPE, ERR_BROKEN_PIPE, "Broken pipe")
+#endif
+#ifdef EDEADLK
+        C_RESULT_OS_ERROR(EDEADLK, ERR_LOCK_FAILED, "Resource deadlock avoided")
+#endif
+#ifdef ENAMETOOLONG
+        C_RESULT_OS_ERROR(ENAMETOOLONG, ERR_INVALID_PATH, "File name too long")
+#endif
+#ifdef ENOLCK
+        C_RESULT_OS_ERROR(ENOLCK, ERR_LOCK_FAILED, "No locks available")
+#endif
+#ifdef ENOSYS
+        C_RESULT_OS_ERROR(ENOSYS, ERR_NOT_IMPLEMENTED, "Function not implemented")
+#endif
+#if defined(ENOTEMPTY) && (!defined(EEXIST) || ENOTEMPTY != EEXIST) // The same value on AIX
+        C_RESULT_OS_ERROR(ENOTEMPTY, ERR_DIRECTORY_NOT_EMPTY, "Directory not empty")
+#endif
+#ifdef ELOOP
+        C_RESULT_OS_ERROR(ELOOP, ERR_INVALID_PATH, "Too many levels of symbolic links")
+#endif
+#ifdef EOVERFLOW
+        C_RESULT_OS_ERROR(EOVERFLOW, ERR_OUT_OF_RANGE, "Value too large for defined data type")
+#endif
+#ifdef EBADMSG
+        C_RESULT_OS_ERROR(EBADMSG, ERR_BAD_FORMAT, "Bad message")
+#endif
+#ifdef EPROTO
+        C_RESULT_OS_ERROR(EPROTO, ERR_PROTOCOL_ERROR, "Protocol error")
+#endif
+#ifdef ENOTSUP
+        C_RESULT_OS_ERROR(ENOTSUP, ERR_NOT_IMPLEMENTED, "Operation not supported")
+#endif
+#ifdef ENOBUFS
+        C_RESULT_OS_ERROR(ENOBUFS, ERR_NO_SPACE, "No buffer space available")
+#endif
+#ifdef EADDRINUSE
+        C_RESULT_OS_ERROR(EADDRINUSE, ERR_RESOURCE_BUSY, "Address already in use")
+#endif
+#ifdef ENETDOWN
+        C_RESULT_OS_ERROR(ENETDOWN, ERR_NETWORK_ERROR, "Network is down")
+#endif
+#ifdef ENETUNREACH
+        C_RESULT_OS_ERROR(ENETUNREACH, ERR_NETWORK_ERROR, "Network is unreachable")
+#endif
+#ifdef EHOSTUNREACH
+        C_RESULT_OS_ERROR(EHOSTUNREACH, ERR_NETWORK_ERROR, "No route to host")
+#endif
+#ifdef ECONNABORTED
+        C_RESULT_OS_ERROR(ECONNABORTED, ERR_NETWORK_ERROR, "Software caused connection abort")
+#endif
+#ifdef ECONNRESET
+        C_RESULT_OS_ERROR(ECONNRESET, ERR_NETWORK_ERROR, "Connection reset by peer")
+#endif
+#ifdef ENOTCONN
+        C_RESULT_OS_ERROR(ENOTCONN, ERR_CONNECTION_FAILED, "Transport endpoint is not connected")
+#endif
+#ifdef ETIMEDOUT
+        C_RESULT_OS_ERROR(ETIMEDOUT, ERR_TIMEOUT, "Connection timed out")
+#endif
+#ifdef ECONNREFUSED
+        C_RESULT_OS_ERROR(ECONNREFUSED, ERR_CONNECTION_FAILED, "Connection refused")
+#endif
+#ifdef ECANCELED
+        C_RESULT_OS_ERROR(ECANCELED, ERR_INTERRUPTED, "Operation canceled")
+#endif
+        default:
+            return C_RESULT_OS_ERROR_UNKNOWN;
+    }
+}
+
+// Win32 error codes, by value so that this header does not need <windows.h>
+static inline ResultOsError c_result_win32_lookup(const unsigned long error) {
+    switch (error) {
+        C_RESULT_OS_ERROR(2, ERR_FILE_NOT_FOUND, "The system cannot find the file specified") // ERROR_FILE_NOT_FOUND
+        C_RESULT_OS_ERROR(3, ERR_FILE_NOT_FOUND, "The system cannot find the path specified") // ERROR_PATH_NOT_FOUND
+        C_RESULT_OS_ERROR(4, ERR_TOO_MANY_OPEN_FILES, "The system cannot open the file") // ERROR_TOO_MANY_OPEN_FILES
+        C_RESULT_OS_ERROR(5, ERR_PERMISSION_DENIED, "Access is denied") // ERROR_ACCESS_DENIED
+        C_RESULT_OS_ERROR(6, ERR_INVALID_INPUT, "The handle is invalid") // ERROR_INVALID_HANDLE
+        C_RESULT_OS_ERROR(8, ERR_OUT_OF_MEMORY, "Not enough memory resources are available") // ERROR_NOT_ENOUGH_MEMORY
+        C_RESULT_OS_ERROR(13, ERR_BAD_FORMAT, "The data is invalid") // ERROR_INVALID_DATA
+        C_RESULT_OS_ERROR(14, ERR_OUT_OF_MEMORY, "Not enough storage is available") // ERROR_OUTOFMEMORY
+        C_RESULT_OS_ERROR(15, ERR_INVALID_PATH, "The system cannot find the drive specified") // ERROR_INVALID_DRIVE
+        C_RESULT_OS_ERROR(19, ERR_READ_ONLY, "The media is write protected") // ERROR_WRITE_PROTECT
+        C_RESULT_OS_ERROR(21, ERR_DEVICE_ERROR, "The device is not ready") // ERROR_NOT_READY
+        C_RESULT_OS_ERROR(23, ERR_DEVICE_ERROR, "Data error (cyclic redundancy check)") // ERROR_CRC
+        C_RESULT_OS_ERROR(29, ERR_FILE_IO, "The system cannot write to the specified device") // ERROR_WRITE_FAULT
+        C_RESULT_OS_ERROR(30, ERR_FILE_IO, "The system cannot read from the specified device") // ERROR_READ_FAULT
+        C_RESULT_OS_ERROR(32, ERR_RESOURCE_BUSY, "The file is being used by another process") // ERROR_SHARING_VIOLATION
+        C_RESULT_OS_ERROR(33, ERR_LOCK_FAILED, "The file is locked by another process") // ERROR_LOCK_VIOLATION
+        C_RESULT_OS_ERROR(38, ERR_END_OF_STREAM, "Reached the end of the file") // ERROR_HANDLE_EOF
+        C_RESULT_OS_ERROR(50, ERR_NOT_IMPLEMENTED, "The request is not supported") // ERROR_NOT_SUPPORTED
+        C_RESULT_OS_ERROR(80, ERR_ALREADY_EXISTS, "The file exists") // ERROR_FILE_EXISTS
+        C_RESULT_OS_ERROR(87, ERR_INVALID_INPUT, "The parameter is incorrect") // ERROR_INVALID_PARAMETER
+        C_RESULT_OS_ERROR(109, ERR_BROKEN_PIPE, "The pipe has been ended") // ERROR_BROKEN_PIPE
+        C_RESULT_OS_ERROR(112, ERR_NO_SPACE, "There is not enough space on the disk") // ERROR_DISK_FULL
+        C_RESULT_OS_ERROR(120, ERR_NOT_IMPLEMENTED, "This function is not supported") // ERROR_CALL_NOT_IMPLEMENTED
+        C_RESULT_OS_ERROR(122, ERR_BUFFER_OVERFLOW, "The data area is too small") // ERROR_INSUFFICIENT_BUFFER
+        C_RESULT_OS_ERROR(123, ERR_INVALID_PATH, "The file name syntax is incorrect") // ERROR_INVALID_NAME
+        C_RESULT_OS_ERROR(145, ERR_DIRECTORY_NOT_EMPTY, "The directory is not empty") // ERROR_DIR_NOT_EMPTY
+        C_RESULT_OS_ERROR(161, ERR_INVALID_PATH, "The specified path is invalid") // ERROR_BAD_PATHNAME
+        C_RESULT_OS_ERROR(170, ERR_RESOURCE_BUSY, "The requested resource is in use") // ERROR_BUSY
+        C_RESULT_OS_ERROR(183, ERR_ALREADY_EXISTS, "The file already exists") // ERROR_ALREADY_EXISTS
+        C_RESULT_OS_ERROR(206, ERR_INVALID_PATH, "The file name is too long") // ERROR_FILENAME_EXCED_RANGE
+        C_RESULT_OS_ERROR(231, ERR_RESOURCE_BUSY, "All pipe instances are busy") // ERROR_PIPE_BUSY
+        C_RESULT_OS_ERROR(232, ERR_BROKEN_PIPE, "The pipe is being closed") // ERROR_NO_DATA
+        C_RESULT_OS_ERROR(258, ERR_TIMEOUT, "The wait operation timed out") // WAIT_TIMEOUT
+        C_RESULT_OS_ERROR(267, ERR_NOT_A_DIRECTORY, "The directory name is invalid") // ERROR_DIRECTORY
+        C_RESULT_OS_ERROR(534, ERR_OUT_OF_RANGE, "Arithmetic result exceeded 32 bits") // ERROR_ARITHMETIC_OVERFLOW
+        C_RESULT_OS_ERROR(995, ERR_INTERRUPTED, "The I/O operation has been aborted") // ERROR_OPERATION_ABORTED
+        C_RESULT_OS_ERROR(1113, ERR_ILLEGAL_SEQUENCE, "No mapping for the character") // ERROR_NO_UNICODE_TRANSLATION
+        C_RESULT_OS_ERROR(1168, ERR_NOT_FOUND, "Element not found") // ERROR_NOT_FOUND
+        C_RESULT_OS_ERROR(1223, ERR_INTERRUPTED, "The operation was canceled by the user") // ERROR_CANCELLED
+        C_RESULT_OS_ERROR(1225, ERR_CONNECTION_FAILED, "The remote computer refused it") // ERROR_CONNECTION_REFUSED
+        // ERROR_NETWORK_UNREACHABLE
+        C_RESULT_OS_ERROR(1231, ERR_NETWORK_ERROR, "The network location cannot be reached")
+        C_RESULT_OS_ERROR(1314, ERR_PERMISSION_DENIED, "A required privilege is not held") // ERROR_PRIVILEGE_NOT_HELD
+        C_RESULT_OS_ERROR(1460, ERR_TIMEOUT, "This operation returned because the timeout expired") // ERROR_TIMEOUT
+        C_RESULT_OS_ERROR(10054, ERR_NETWORK_ERROR, "An existing connection was forcibly closed") // WSAECONNRESET
+        C_RESULT_OS_ERROR(10060, ERR_TIMEOUT, "The connection attempt timed out") // WSAETIMEDOUT
+        C_RESULT_OS_ERROR(10061, ERR_CONNECTION_FAILED, "The target machine actively refused it") // WSAECONNREFUSED
+        default:
+            return C_RESULT_OS_ERROR_UNKNOWN;
+    }
+}
+#undef C_RESULT_OS_ERROR
+#undef C_RESULT_OS_ERROR_UNKNOWN
+
+// Result code of an errno value, e.g. ERR_FILE_NOT_FOUND for ENOENT. ERR_UNKNOWN for unlisted values.
+static inline ResultCode result_code_from_errno(const int error) {
+    return c_result_errno_lookup(error).code;
+}
+
+// Result code of a Win32 error code (GetLastError(), WSAGetLastError()). ERR_UNKNOWN for unlisted values.
+static inline ResultCode result_code_from_win32(const unsigned long error) {
+    return c_result_win32_lookup(error).code;
+}
 
-        // Success values
-        union {
-            void *pointer;
-            char *string;
-            int int_val;
-            long long_val;
-            float float_val;
-            double double_val;
-            bool bool_val;
-            char char_val;
-            short short_val;
-            unsigned int uint_val;
-            unsigned long ulong_val;
-            size_t size_val;
-            int8_t int8_val;
-            uint8_t uint8_val;
-            int16_t int16_val;
-            uint16_t uint16_val;
-            int32_t int32_val;
-            uint32_t uint32_val;
-            int64_t int64_val;
-            uint64_t uint64_val;
+static inline Result c_result_make_os_error(const ResultCode code, const uint8_t storage, const unsigned long error) {
+    Result res = C_RESULT_INIT;
+    res.code = code;
+    res.value_type = RESULT_TYPE_NONE;
+    res.owns_memory = false;
+    res.message_storage = storage;
+    res.data.os_error = (uint32_t) error;
+    C_RESULT_STATS_ERROR(code);
+    return res;
+}
 
-            // Custom type data
-            struct {
-                void *data;
-                CustomDestructor destructor;
-            } custom;
-        } value;
-    } data;
-} Result;
+// Error creation from an errno value: the code comes from a static table, the value is kept in the Result (see
+// result_error_errno()) and the message is static text looked up when asked for. No allocation, no copy.
+WARN_UNUSED_RESULT static inline Result make_error_from_errno(const int error) {
+    return c_result_make_os_error(result_code_from_errno(error), RESULT_MESSAGE_ERRNO, (unsigned long) error);
+}
 
-// Error creation
-WARN_UNUSED_RESULT static inline Result make_error(const ResultCode code, const char *message) {
-    Result res = {0}; // Zero-initialize the entire struct
+// Error creation from a Win32 error code (a DWORD from GetLastError()), like make_error_from_errno()
+WARN_UNUSED_RESULT static inline Result make_error_from_win32(const unsigned long error) {
+    return c_result_make_os_error(result_code_from_win32(error), RESULT_MESSAGE_WIN32, error);
+}
+
+// Error creation from a printf-style format and a va_list, see make_errorf()
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 7
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation" // Truncation is how too long messages are detected
+#endif
+WARN_UNUSED_RESULT C_RESULT_API Result make_errorv(const ResultCode code, const char *format, va_list args)
+#ifdef C_RESULT_DEFINITIONS
+{
+#ifdef C_RESULT_NO_MESSAGES
+    (void) format;
+    (void) args;
+    return c_result_error_without_message(code);
+#else
+    Result res = C_RESULT_INIT;
     res.code = code;
     res.value_type = RESULT_TYPE_NONE;
-    res.owns_memory = true; // Error messages are always owned by the Result
+    res.owns_memory = false;
+    if (!format) {
+        C_RESULT_STATS_ERROR(code);
+        return res;
+    }
+
+    va_list inline_args;
+    va_copy(inline_args, args);
+    const int length = vsnprintf(res.data.inline_message, sizeof(res.data.inline_message), format, inline_args);
+    va_end(inline_args);
+    if (length < 0) {
+        C_RESULT_STATS_ERROR(code);
+        return res; // Encoding error, keep the code without a message
+    }
+    if ((size_t) length < sizeof(res.data.inline_message)) {
+        res.message_storage = RESULT_MESSAGE_INLINE;
+        C_RESULT_STATS_ERROR(code);
+        return res;
+    }
 
+    // Too long for the inline buffer, format again into the thread arena or a heap copy
+    char *message = (char *) c_result_thread_arena_allocate(NULL, (size_t) length + 1);
     if (message) {
-        res.data.message = malloc(strlen(message) + 1);
-        if (res.data.message) {
-            strcpy(res.data.message, message);
-        } else {
+        res.message_storage = RESULT_MESSAGE_ARENA;
+    } else {
+        message = (char *) C_RESULT_MALLOC((size_t) length + 1);
+        if (!message) {
             res.code = ERR_OUT_OF_MEMORY;
+            C_RESULT_STATS_ERROR(res.code);
+            return res;
         }
+        res.message_storage = RESULT_MESSAGE_HEAP;
+        res.owns_memory = true;
     }
+    vsnprintf(message, (size_t) length + 1, format, args);
+    res.data.message = message;
+    C_RESULT_STATS_MESSAGE((size_t) length + 1);
+    C_RESULT_STATS_ERROR(code);
+    return res;
+#endif
+}
+#else
+;
+#endif
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 7
+#pragma GCC diagnostic pop
+#endif
+
+// Error creation from a printf-style format.
+// Messages shorter than C_RESULT_INLINE_MESSAGE_SIZE are formatted straight into the Result, without allocating.
+WARN_UNUSED_RESULT PRINTF_FORMAT(2, 3) C_RESULT_API Result make_errorf(const ResultCode code, const char *format, ...)
+#ifdef C_RESULT_DEFINITIONS
+{
+    va_list args;
+    va_start(args, format);
+    const Result res = make_errorv(code, format, args);
+    va_end(args);
     return res;
 }
+#else
+;
+#endif
+
+// Same as make_error_static(), but only accepts string literals
+#define make_error_literal(code, literal) make_error_static(code, "" literal "")
 
 // Success creation functions for different types
 WARN_UNUSED_RESULT static inline Result make_success_ptr(void *value, const bool ownership) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_POINTER;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_POINTER);
     res.owns_memory = ownership;
     res.data.value.pointer = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_string(char *value, const bool ownership) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_STRING;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_STRING);
     res.owns_memory = ownership;
     res.data.value.string = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_int(const int value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_INT;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_INT);
     res.owns_memory = false;
     res.data.value.int_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_long(const long value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_LONG;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_LONG);
     res.owns_memory = false;
     res.data.value.long_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_float(const float value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_FLOAT;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_FLOAT);
     res.owns_memory = false;
     res.data.value.float_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_double(const double value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_DOUBLE;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_DOUBLE);
     res.owns_memory = false;
     res.data.value.double_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_bool(const bool value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_BOOL;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_BOOL);
     res.owns_memory = false;
     res.data.value.bool_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_char(const char value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_CHAR;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_CHAR);
     res.owns_memory = false;
     res.data.value.char_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_short(const short value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_SHORT;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_SHORT);
     res.owns_memory = false;
     res.data.value.short_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_uint(const unsigned int value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_UINT;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_UINT);
     res.owns_memory = false;
     res.data.value.uint_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_ulong(const unsigned long value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_ULONG;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_ULONG);
     res.owns_memory = false;
     res.data.value.ulong_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_size_t(const size_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_SIZE_T;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_SIZE_T);
     res.owns_memory = false;
     res.data.value.size_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_int8(const int8_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_INT8;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_INT8);
     res.owns_memory = false;
     res.data.value.int8_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_uint8(const uint8_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_UINT8;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_UINT8);
     res.owns_memory = false;
     res.data.value.uint8_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_int16(const int16_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_INT16;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_INT16);
     res.owns_memory = false;
     res.data.value.int16_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_uint16(const uint16_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_UINT16;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_UINT16);
     res.owns_memory = false;
     res.data.value.uint16_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_int32(const int32_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_INT32;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_INT32);
     res.owns_memory = false;
     res.data.value.int32_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_uint32(const uint32_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_UINT32;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_UINT32);
     res.owns_memory = false;
     res.data.value.uint32_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_int64(const int64_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_INT64;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_INT64);
     res.owns_memory = false;
     res.data.value.int64_val = value;
     return res;
 }
 
 WARN_UNUSED_RESULT static inline Result make_success_uint64(const uint64_t value) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_UINT64;
+    C_RESULT_STATS_CREATED(RESULT_TYPE_UINT64);
     res.owns_memory = false;
     res.data.value.uint64_val = value;
     return res;
@@ -326,61 +1460,330 @@ WARN_UNUSED_RESULT static inline Result make_success_uint64(const uint64_t value
 // Custom type creation
 WARN_UNUSED_RESULT static inline Result make_success_custom(void *data, const CustomDestructor destructor,
                                                             const bool owns_memory) {
-    Result res = {0};
+    Result res = C_RESULT_INIT;
     res.code = SUCCESS;
     res.value_type = RESULT_TYPE_CUSTOM;
     res.owns_memory = owns_memory;
+#ifdef C_RESULT_COMPACT
+    if (owns_memory && destructor) {
+        ResultCustom *boxed = (ResultCustom *) C_RESULT_MALLOC(sizeof(ResultCustom));
+        if (!boxed) {
+            destructor(data); // Ownership was passed to us
+            return make_error_static(ERR_OUT_OF_MEMORY, "Failed to allocate custom type box");
+        }
+        boxed->data = data;
+        boxed->destructor = destructor;
+        res.data.value.custom.boxed = boxed;
+        res.flags = RESULT_FLAG_CUSTOM_BOXED;
+        C_RESULT_STATS_PAYLOAD(sizeof(ResultCustom));
+    } else {
+        res.data.value.custom.data = data; // Destructor is never called without ownership
+    }
+#else
     res.data.value.custom.data = data;
     res.data.value.custom.destructor = destructor;
+#endif
+    C_RESULT_STATS_CREATED(RESULT_TYPE_CUSTOM);
+    return res;
+}
+
+// Shared payload creation. The payload is allocated once and reference counted: result_clone() only bumps the
+// count and free_result() drops it, calling destructor (or C_RESULT_FREE when NULL) once the last reference is gone.
+WARN_UNUSED_RESULT C_RESULT_API Result c_result_make_shared(const ResultValueType value_type, void *data,
+                                                             const CustomDestructor destructor)
+#ifdef C_RESULT_DEFINITIONS
+{
+    ResultShared *shared = (ResultShared *) C_RESULT_MALLOC(sizeof(ResultShared));
+    if (!shared) {
+        if (destructor) {
+            destructor(data); // Ownership was passed to us
+        } else {
+            C_RESULT_FREE(data);
+        }
+        return make_error_static(ERR_OUT_OF_MEMORY, "Failed to allocate shared payload");
+    }
+    shared->custom.data = data;
+    shared->custom.destructor = destructor;
+    C_RESULT_STATS_PAYLOAD(sizeof(ResultShared));
+    c_result_atomic_init(&shared->references, 1);
+
+    Result res = C_RESULT_INIT;
+    res.code = SUCCESS;
+    res.value_type = value_type;
+    C_RESULT_STATS_CREATED(value_type);
+    res.owns_memory = true; // One reference
+    res.flags = RESULT_FLAG_SHARED;
+    res.data.value.shared = shared;
     return res;
 }
+#else
+;
+#endif
+
+WARN_UNUSED_RESULT static inline Result make_success_shared(void *data, const CustomDestructor destructor) {
+    return c_result_make_shared(RESULT_TYPE_CUSTOM, data, destructor);
+}
+
+WARN_UNUSED_RESULT static inline Result make_success_shared_string(char *value, const CustomDestructor destructor) {
+    return c_result_make_shared(RESULT_TYPE_STRING, value, destructor);
+}
 
 static inline bool is_result_success(const Result res) {
     return res.code == SUCCESS;
 }
 
+// Allocator registration, meant to happen once at startup before results use the allocator.
+// The allocator must outlive every result tagged with its id. On success the result holds the id as uint8.
+WARN_UNUSED_RESULT C_RESULT_API Result result_register_allocator(const ResultAllocator *allocator)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!allocator || !allocator->allocate) {
+        return make_error_static(ERR_NULL_POINTER, "Allocator has no allocate function");
+    }
+    for (uint8_t id = 1; id < C_RESULT_MAX_ALLOCATORS; id++) {
+        if (!c_result_allocators[id]) {
+            c_result_allocators[id] = allocator;
+            return make_success_uint8(id);
+        }
+    }
+    return make_error_static(ERR_NO_SPACE, "Too many registered allocators");
+}
+#else
+;
+#endif
+
+static inline void result_unregister_allocator(const uint8_t allocator) {
+    if (allocator != RESULT_ALLOCATOR_DEFAULT && allocator < C_RESULT_MAX_ALLOCATORS) {
+        c_result_allocators[allocator] = NULL;
+    }
+}
+
+// Shell state left behind by free_result() and result_move(): an ERR_INVALID_STATE error owning nothing
+static inline void c_result_make_shell(Result *result) {
+    result->code = ERR_INVALID_STATE;
+    result->owns_memory = false;
+    result->message_storage = RESULT_MESSAGE_NONE;
+    result->flags = 0;
+}
+
+// Drops one reference to a shared payload, destroying it with the last one
+C_RESULT_API void c_result_shared_release(ResultShared *shared)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (c_result_atomic_fetch_sub(&shared->references, 1, C_RESULT_ACQ_REL) == 1) {
+        if (shared->custom.destructor) {
+            shared->custom.destructor(shared->custom.data);
+        } else {
+            C_RESULT_FREE(shared->custom.data);
+        }
+        C_RESULT_FREE(shared);
+    }
+}
+#else
+;
+#endif
+
 // Free result resources with ownership checking
 // Free result resources
-static inline void free_result(Result *result) {
+C_RESULT_API void free_result(Result *result)
+#ifdef C_RESULT_DEFINITIONS
+{
     if (!result) return;
 
-    if (is_result_success(*result) && result->owns_memory) {
+    if (result->owns_memory || (result->flags & RESULT_FLAG_CUSTOM_BOXED)) {
+        C_RESULT_STATS_FREE();
+    }
+
+    if (is_result_success(*result) && result->owns_memory && (result->flags & RESULT_FLAG_SHARED)) {
+        c_result_shared_release(result->data.value.shared);
+    } else if (is_result_success(*result) && result->owns_memory) {
         switch (result->value_type) {
             case RESULT_TYPE_POINTER:
-                free(result->data.value.pointer);
+                c_result_release(result_allocator(result), result->data.value.pointer);
                 break;
             case RESULT_TYPE_STRING:
-                free(result->data.value.string);
+                c_result_release(result_allocator(result), result->data.value.string);
                 break;
             case RESULT_TYPE_CUSTOM:
+#ifdef C_RESULT_COMPACT
+                if (result->flags & RESULT_FLAG_CUSTOM_BOXED) {
+                    result->data.value.custom.boxed->destructor(result->data.value.custom.boxed->data);
+                } else {
+                    c_result_release(result_allocator(result), result->data.value.custom.data);
+                }
+                break;
+#else
                 if (result->data.value.custom.destructor) {
                     result->data.value.custom.destructor(result->data.value.custom.data);
                 } else {
-                    free(result->data.value.custom.data);
+                    c_result_release(result_allocator(result), result->data.value.custom.data);
                 }
                 break;
+#endif
             default:
                 break;
         }
-    } else if (result->owns_memory && result->data.message) {
-        free(result->data.message);
+    } else if (result->owns_memory && result->message_storage == RESULT_MESSAGE_HEAP) {
+        c_result_release(result_allocator(result), result->data.message);
+    } else if (result->owns_memory && result->message_storage == RESULT_MESSAGE_CONTEXT) {
+        for (ResultContextFrame *frame = result->data.context; frame;) {
+            ResultContextFrame *next = frame->next;
+            if (!next) {
+                free_result(&frame->cause); // Never a chain itself
+            }
+            c_result_context_release(frame);
+            frame = next;
+        }
     }
 
-    result->code = ERR_INVALID_STATE;
-    result->owns_memory = false;
+#ifdef C_RESULT_COMPACT
+    // The box belongs to the Result even if ownership of the payload was transferred
+    if (result->flags & RESULT_FLAG_CUSTOM_BOXED) {
+        C_RESULT_FREE(result->data.value.custom.boxed);
+    }
+#endif
+
+    c_result_make_shell(result);
+}
+#else
+;
+#endif
+
+// Moves src into dst, leaving src in the shell state of free_result(), so that freeing both is safe.
+// dst is overwritten without being freed.
+static inline void result_move(Result *dst, Result *src) {
+    *dst = *src;
+    c_result_make_shell(src);
+}
+
+// Copy of a result. Shared payloads only get their reference count bumped, owned strings and heap messages are
+// duplicated, borrowed payloads are copied as is. Uniquely owned pointer and custom payloads cannot be cloned.
+WARN_UNUSED_RESULT C_RESULT_API Result result_clone(const Result *result)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!result->owns_memory) {
+        Result copy = *result;
+#ifdef C_RESULT_COMPACT
+        // The box stays with the original, the copy borrows the payload in line
+        if (copy.flags & RESULT_FLAG_CUSTOM_BOXED) {
+            copy.data.value.custom.data = copy.data.value.custom.boxed->data;
+            copy.flags &= (uint8_t) ~RESULT_FLAG_CUSTOM_BOXED;
+        }
+#endif
+        return copy;
+    }
+    if (!is_result_success(*result) && result->message_storage == RESULT_MESSAGE_CONTEXT) {
+        // Frames are copied in order, the oldest one with a clone of the wrapped error
+        Result copy = *result;
+        ResultContextFrame **tail = &copy.data.context;
+        for (const ResultContextFrame *frame = result->data.context; frame; frame = frame->next) {
+            ResultContextFrame *frame_copy = c_result_context_acquire();
+            if (!frame_copy) {
+                *tail = NULL;
+                free_result(&copy);
+                return make_error_static(ERR_OUT_OF_MEMORY, "Failed to clone error context");
+            }
+            memcpy(frame_copy->text, frame->text, sizeof(frame->text));
+            frame_copy->next = NULL;
+            if (frame->next) {
+                c_result_make_shell(&frame_copy->cause);
+            } else {
+                frame_copy->cause = result_clone(&frame->cause);
+            }
+            *tail = frame_copy;
+            tail = &frame_copy->next;
+        }
+        return copy;
+    }
+    if (!is_result_success(*result)) {
+        return result->message_storage == RESULT_MESSAGE_HEAP ? make_error(result->code, result->data.message) : *result;
+    }
+    if (result->flags & RESULT_FLAG_SHARED) {
+        c_result_atomic_fetch_add(&result->data.value.shared->references, 1, C_RESULT_RELAXED);
+        return *result;
+    }
+    if (result->value_type == RESULT_TYPE_STRING) {
+        const size_t size = strlen(result->data.value.string) + 1;
+        char *copy = (char *) C_RESULT_MALLOC(size);
+        if (!copy) {
+            return make_error_static(ERR_OUT_OF_MEMORY, "Failed to clone string");
+        }
+        memcpy(copy, result->data.value.string, size);
+        C_RESULT_STATS_PAYLOAD(size);
+        return make_success_string(copy, true);
+    }
+    if (result->value_type == RESULT_TYPE_POINTER || result->value_type == RESULT_TYPE_CUSTOM) {
+        return make_error_static(ERR_INVALID_OPERATION, "Cannot clone a uniquely owned payload");
+    }
+    return *result;
+}
+#else
+;
+#endif
+
+// Copies a message living in the calling thread's arena to the heap, also the one of the error wrapped by a context
+// chain, so that the result survives c_result_thread_arena_reset() and can move to another thread. Inline messages
+// live inside the Result and travel with it. Returns SUCCESS, or ERR_OUT_OF_MEMORY with the result unchanged.
+static inline ResultCode c_result_detach_message(Result *result) {
+    if (is_result_success(*result)) {
+        return SUCCESS;
+    }
+    if (result->message_storage == RESULT_MESSAGE_CONTEXT) {
+        if (!result->owns_memory) {
+            return SUCCESS; // A borrowed chain, e.g. a batch view, belongs to its owner
+        }
+        ResultContextFrame *oldest = result->data.context;
+        while (oldest->next) {
+            oldest = oldest->next;
+        }
+        return c_result_detach_message(&oldest->cause);
+    }
+    if (result->message_storage != RESULT_MESSAGE_ARENA) {
+        return SUCCESS;
+    }
+    const size_t size = strlen(result->data.message) + 1;
+    char *message = (char *) C_RESULT_MALLOC(size);
+    if (!message) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    memcpy(message, result->data.message, size);
+    result->data.message = message;
+    result->message_storage = RESULT_MESSAGE_HEAP;
+    result->owns_memory = true;
+    result_set_allocator(result, RESULT_ALLOCATOR_DEFAULT);
+    C_RESULT_STATS_MESSAGE(size);
+    return SUCCESS;
+}
+
+// Helper function to get the reference count of a shared payload, 0 for other results
+static inline size_t result_shared_references(const Result *result) {
+    if (!is_result_success(*result) || !(result->flags & RESULT_FLAG_SHARED)) {
+        return 0;
+    }
+    return c_result_atomic_load(&result->data.value.shared->references, C_RESULT_ACQUIRE);
+}
+
+// Reports an access to a result of the wrong type, in DEBUG builds
+C_RESULT_API void c_result_type_mismatch(const char *file, const int line, const int expected, const int actual)
+#ifdef C_RESULT_DEFINITIONS
+{
+    fprintf(stderr, "Error: Type mismatch at %s:%d (expected %d, got %d)\n", file, line, expected, actual);
 }
+#else
+;
+#endif
 
 // Type-safe access macros
 #ifdef DEBUG
-#include <stdio.h>
+// The conditional operator converts default_val to the type of the member, as in release builds
 #define ACCESS_RESULT(result, type_enum, member, default_val) \
     (is_result_success(result) && (result).value_type == type_enum ? \
     (result).data.value.member : \
-    (fprintf(stderr, "Error: Type mismatch at %s:%d (expected %d, got %d)\n", \
-           __FILE__, __LINE__, type_enum, (result).value_type), (typeof((result).data.value.member))default_val))
+    (c_result_type_mismatch(__FILE__, __LINE__, type_enum, (result).value_type), default_val))
 
 #define access_result_ptr(result, type) ((type *)ACCESS_RESULT(result, RESULT_TYPE_POINTER, pointer, NULL))
-#define access_result_string(result) ((char*)ACCESS_RESULT(result, RESULT_TYPE_STRING, string, (char*)NULL))
+#define access_result_string(result) \
+    (ACCESS_RESULT(result, RESULT_TYPE_STRING, string, (char*)NULL) ? RESULT_STRING_DATA(result) : (char*)NULL)
 #define access_result_int(result) ACCESS_RESULT(result, RESULT_TYPE_INT, int_val, 0)
 #define access_result_long(result) ACCESS_RESULT(result, RESULT_TYPE_LONG, long_val, 0L)
 #define access_result_float(result) ACCESS_RESULT(result, RESULT_TYPE_FLOAT, float_val, 0.0f)
@@ -399,14 +1802,15 @@ static inline void free_result(Result *result) {
 #define access_result_uint32(result) ACCESS_RESULT(result, RESULT_TYPE_UINT32, uint32_val, (uint32_t)0)
 #define access_result_int64(result) ACCESS_RESULT(result, RESULT_TYPE_INT64, int64_val, (int64_t)0)
 #define access_result_uint64(result) ACCESS_RESULT(result, RESULT_TYPE_UINT64, uint64_val, (uint64_t)0)
-#define access_result_custom(result) ACCESS_RESULT(result, RESULT_TYPE_CUSTOM, custom.data, NULL)
+#define access_result_custom(result) \
+    (ACCESS_RESULT(result, RESULT_TYPE_CUSTOM, custom.data, NULL) ? RESULT_CUSTOM_DATA(result) : NULL)
 #else
 #define ACCESS_RESULT(result, type_enum, member, default_val) \
     (is_result_success(result) && (result).value_type == type_enum ? (result).data.value.member : default_val)
 
 // Same macros without debug checks but with basic type validation
 #define access_result_ptr(result, type) ((type *)(is_result_success(result) ? (result).data.value.pointer : NULL))
-#define access_result_string(result) (is_result_success(result) ? (result).data.value.string : NULL)
+#define access_result_string(result) (is_result_success(result) ? RESULT_STRING_DATA(result) : NULL)
 #define access_result_int(result) (is_result_success(result) ? (result).data.value.int_val : 0)
 #define access_result_long(result) (is_result_success(result) ? (result).data.value.long_val : 0L)
 #define access_result_float(result) (is_result_success(result) ? (result).data.value.float_val : 0.0f)
@@ -425,17 +1829,359 @@ static inline void free_result(Result *result) {
 #define access_result_uint32(result) (is_result_success(result) ? (result).data.value.uint32_val : (uint32_t)0)
 #define access_result_int64(result) (is_result_success(result) ? (result).data.value.int64_val : (int64_t)0)
 #define access_result_uint64(result) (is_result_success(result) ? (result).data.value.uint64_val : (uint64_t)0)
-#define access_result_custom(result) (is_result_success(result) ? (result).data.value.custom.data : NULL)
+#define access_result_custom(result) (is_result_success(result) ? RESULT_CUSTOM_DATA(result) : NULL)
+#endif
+
+// Typed reads for result_get(): true and *out set when the result is a success holding that C type. Fixed-width
+// tags are accepted for the fundamental type they have the representation of, e.g. RESULT_TYPE_INT32 for int:
+// aliases is a condition on the tag, named type.
+#define C_RESULT_GET_(suffix, T, member, tag, aliases) \
+    static inline bool c_result_get_##suffix(const Result *result, T *out) { \
+        const unsigned type = result->value_type; \
+        if (is_result_success(*result) && (type == (tag) || (aliases))) { \
+            *out = result->data.value.member; \
+            return true; \
+        } \
+        return false; \
+    }
+C_RESULT_GET_(char, char, char_val, RESULT_TYPE_CHAR, false)
+C_RESULT_GET_(schar, signed char, int8_val, RESULT_TYPE_INT8, false)
+C_RESULT_GET_(uchar, unsigned char, uint8_val, RESULT_TYPE_UINT8, false)
+C_RESULT_GET_(short, short, short_val, RESULT_TYPE_SHORT, sizeof(short) == 2 && type == RESULT_TYPE_INT16)
+C_RESULT_GET_(ushort, unsigned short, uint16_val, RESULT_TYPE_UINT16, false)
+C_RESULT_GET_(int, int, int_val, RESULT_TYPE_INT, sizeof(int) == 4 && type == RESULT_TYPE_INT32)
+C_RESULT_GET_(uint, unsigned int, uint_val, RESULT_TYPE_UINT, sizeof(unsigned int) == 4 && type == RESULT_TYPE_UINT32)
+C_RESULT_GET_(long, long, long_val, RESULT_TYPE_LONG, sizeof(long) == 8 && type == RESULT_TYPE_INT64)
+C_RESULT_GET_(ulong, unsigned long, ulong_val, RESULT_TYPE_ULONG,
+              (sizeof(unsigned long) == 8 && type == RESULT_TYPE_UINT64) ||
+              (sizeof(unsigned long) == sizeof(size_t) && type == RESULT_TYPE_SIZE_T))
+C_RESULT_GET_(llong, long long, int64_val, RESULT_TYPE_INT64, sizeof(long) == 8 && type == RESULT_TYPE_LONG)
+C_RESULT_GET_(ullong, unsigned long long, uint64_val, RESULT_TYPE_UINT64,
+              (sizeof(unsigned long) == 8 && type == RESULT_TYPE_ULONG) ||
+              (sizeof(unsigned long long) == sizeof(size_t) && type == RESULT_TYPE_SIZE_T))
+C_RESULT_GET_(float, float, float_val, RESULT_TYPE_FLOAT, false)
+C_RESULT_GET_(double, double, double_val, RESULT_TYPE_DOUBLE, false)
+C_RESULT_GET_(bool, bool, bool_val, RESULT_TYPE_BOOL, false)
+C_RESULT_GET_(ptr, void *, pointer, RESULT_TYPE_POINTER, false)
+#undef C_RESULT_GET_
+
+static inline bool c_result_get_string(const Result *result, char **out) {
+    if (is_result_success(*result) && result->value_type == RESULT_TYPE_STRING) {
+        *out = RESULT_STRING_DATA(*result);
+        return true;
+    }
+    return false;
+}
+
+WARN_UNUSED_RESULT static inline Result c_result_make_success_borrowed_string(char *value) {
+    return make_success_string(value, false);
+}
+
+WARN_UNUSED_RESULT static inline Result c_result_make_success_borrowed_const_string(const char *value) {
+    return make_success_string((char *) value, false);
+}
+
+WARN_UNUSED_RESULT static inline Result c_result_make_success_borrowed_ptr(void *value) {
+    return make_success_ptr(value, false);
+}
+
+// Type-generic construction and access (C11 _Generic): the type tag is chosen from the static type of the
+// argument, and unsupported types fail to compile instead of reading the wrong union member at run time.
+//  - make_success(value): make_success_int(), make_success_double(), ... for arithmetic values; char * and
+//    void * values are borrowed (ownership false). Mind that 'c' and true are ints in C: cast them to char or bool.
+//  - result_get(result, &variable): true and variable set when result is a success holding that type.
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__cplusplus)
+#define make_success(value) \
+    _Generic((value), \
+        char: make_success_char, \
+        signed char: make_success_int8, \
+        unsigned char: make_success_uint8, \
+        short: make_success_short, \
+        unsigned short: make_success_uint16, \
+        int: make_success_int, \
+        unsigned int: make_success_uint, \
+        long: make_success_long, \
+        unsigned long: make_success_ulong, \
+        long long: make_success_int64, \
+        unsigned long long: make_success_uint64, \
+        float: make_success_float, \
+        double: make_success_double, \
+        bool: make_success_bool, \
+        char *: c_result_make_success_borrowed_string, \
+        const char *: c_result_make_success_borrowed_const_string, \
+        void *: c_result_make_success_borrowed_ptr)(value)
+
+#define result_get(result, out) \
+    _Generic((out), \
+        char *: c_result_get_char, \
+        signed char *: c_result_get_schar, \
+        unsigned char *: c_result_get_uchar, \
+        short *: c_result_get_short, \
+        unsigned short *: c_result_get_ushort, \
+        int *: c_result_get_int, \
+        unsigned int *: c_result_get_uint, \
+        long *: c_result_get_long, \
+        unsigned long *: c_result_get_ulong, \
+        long long *: c_result_get_llong, \
+        unsigned long long *: c_result_get_ullong, \
+        float *: c_result_get_float, \
+        double *: c_result_get_double, \
+        bool *: c_result_get_bool, \
+        char **: c_result_get_string, \
+        void **: c_result_get_ptr)(&(result), out)
 #endif
 
-// Helper function to get error message
+// Type-specialized results.
+// C_RESULT_DECLARE(Name, T) declares a `struct { ResultCode code; T value; }` named Name, without a type tag
+// or message, so e.g. C_RESULT_DECLARE(ResultI32, int32_t) is 8 bytes and fits in a single register. It also
+// declares make_success_Name(value), make_error_Name(code), is_Name_success(result), access_Name(result),
+// access_Name_or(result, fallback) and free_Name(&result).
+#define C_RESULT_DECLARE_COMMON_(Name, T) \
+    typedef struct { \
+        ResultCode code; \
+        T value; \
+    } Name; \
+    WARN_UNUSED_RESULT static inline Name make_success_##Name(T value) { \
+        Name res; \
+        res.code = SUCCESS; \
+        res.value = value; \
+        return res; \
+    } \
+    WARN_UNUSED_RESULT static inline Name make_error_##Name(const ResultCode code) { \
+        Name res; \
+        memset(&res, 0, sizeof(res)); \
+        res.code = code; \
+        return res; \
+    } \
+    static inline bool is_##Name##_success(const Name res) { \
+        return res.code == SUCCESS; \
+    } \
+    static inline T access_##Name##_or(const Name res, T fallback) { \
+        return res.code == SUCCESS ? res.value : fallback; \
+    } \
+    static inline T access_##Name(const Name res) { \
+        Name zero; \
+        memset(&zero, 0, sizeof(zero)); \
+        return res.code == SUCCESS ? res.value : zero.value; \
+    }
+
+#define C_RESULT_DECLARE(Name, T) \
+    C_RESULT_DECLARE_COMMON_(Name, T) \
+    static inline void free_##Name(Name *result) { \
+        if (!result) return; \
+        result->code = ERR_INVALID_STATE; \
+    }
+
+// Same as C_RESULT_DECLARE(), for values owning resources: free_Name() calls destructor(value) on success
+#define C_RESULT_DECLARE_WITH_DESTRUCTOR(Name, T, destructor) \
+    C_RESULT_DECLARE_COMMON_(Name, T) \
+    static inline void free_##Name(Name *result) { \
+        if (!result) return; \
+        if (result->code == SUCCESS) { \
+            destructor(result->value); \
+        } \
+        result->code = ERR_INVALID_STATE; \
+    }
+
+// Helper function to get the error wrapped by result_wrap(), i.e. the cause held by the oldest frame of the chain.
+// Returns result itself when it carries no context.
+static inline const Result *result_error_cause(const Result *result) {
+    while (!is_result_success(*result) && result->message_storage == RESULT_MESSAGE_CONTEXT) {
+        const ResultContextFrame *frame = result->data.context;
+        while (frame->next) {
+            frame = frame->next;
+        }
+        result = &frame->cause;
+    }
+    return result;
+}
+
+// Helper function to get error message, the message of the wrapped error for results with context.
+// Inline messages live inside the Result, so the returned pointer is only valid as long as *result is.
 static inline const char *result_get_error_message(const Result *result) {
-    if (is_result_success(*result) || result->data.message == NULL) {
+    result = result_error_cause(result);
+    if (is_result_success(*result)) {
+        return "No error message";
+    }
+    if (result->message_storage == RESULT_MESSAGE_ERRNO || result->message_storage == RESULT_MESSAGE_WIN32) {
+#ifdef C_RESULT_NO_MESSAGES
+        return result_code_description(result->code);
+#else
+        if (result->message_storage == RESULT_MESSAGE_ERRNO) {
+            return c_result_errno_lookup((int) result->data.os_error).message;
+        }
+        return c_result_win32_lookup(result->data.os_error).message;
+#endif
+    }
+    if (result->message_storage == RESULT_MESSAGE_NONE) {
+#ifdef C_RESULT_NO_MESSAGES
+        return result_code_description(result->code);
+#else
         return "No error message";
+#endif
+    }
+    if (result->message_storage == RESULT_MESSAGE_INLINE) {
+        return result->data.inline_message;
+    }
+    if (result->message_storage == RESULT_MESSAGE_LOCATION) {
+#ifdef C_RESULT_NO_MESSAGES
+        return result_code_description(result->code);
+#else
+        return result->data.location->message ? result->data.location->message : "No error message";
+#endif
     }
     return result->data.message;
 }
 
+// Helper function to get the source location of an error created with make_error_here(), NULL otherwise
+static inline const ResultLocation *result_error_location(const Result *result) {
+    result = result_error_cause(result);
+    if (is_result_success(*result) || result->message_storage != RESULT_MESSAGE_LOCATION) {
+        return NULL;
+    }
+    return result->data.location;
+}
+
+// Helper functions to get the OS error an error was created from, 0 when it was not created from one
+static inline int result_error_errno(const Result *result) {
+    result = result_error_cause(result);
+    return !is_result_success(*result) && result->message_storage == RESULT_MESSAGE_ERRNO ? (int) result->data.os_error
+                                                                                          : 0;
+}
+
+static inline unsigned long result_error_win32(const Result *result) {
+    result = result_error_cause(result);
+    return !is_result_success(*result) && result->message_storage == RESULT_MESSAGE_WIN32 ? result->data.os_error : 0;
+}
+
+// Pushes an empty frame onto the context chain of an error, starting the chain if needed. NULL when out of memory.
+static inline ResultContextFrame *c_result_context_push(Result *result) {
+    ResultContextFrame *frame = c_result_context_acquire();
+    if (!frame) {
+        return NULL;
+    }
+    if (result->message_storage == RESULT_MESSAGE_CONTEXT && result->owns_memory) {
+        frame->next = result->data.context;
+        c_result_make_shell(&frame->cause);
+    } else {
+        // The error moves into the oldest frame. A borrowed chain (e.g. a batch view) becomes a borrowed cause.
+        frame->next = NULL;
+        frame->cause = *result;
+        result->owns_memory = true;
+        result->message_storage = RESULT_MESSAGE_CONTEXT;
+        result->flags = 0;
+    }
+    result->data.context = frame;
+    return frame;
+}
+
+// Adds context to an error as it propagates, e.g. result_wrap(&res, "Loading the configuration"). The text is
+// copied into a new frame (truncated to C_RESULT_CONTEXT_SIZE - 1 bytes), the message of the error is left as is.
+// Success results are left untouched. Returns SUCCESS, or ERR_OUT_OF_MEMORY when no frame could be allocated,
+// then the error is unchanged.
+C_RESULT_API ResultCode result_wrap(Result *result, const char *context)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!result || !context) {
+        return ERR_NULL_POINTER;
+    }
+#ifdef C_RESULT_NO_MESSAGES
+    return SUCCESS;
+#else
+    if (is_result_success(*result)) {
+        return SUCCESS;
+    }
+    ResultContextFrame *frame = c_result_context_push(result);
+    if (!frame) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    size_t length = 0;
+    while (length < sizeof(frame->text) - 1 && context[length]) {
+        length++;
+    }
+    memcpy(frame->text, context, length);
+    frame->text[length] = '\0';
+    return SUCCESS;
+#endif
+}
+#else
+;
+#endif
+
+// Same as result_wrap(), with the context formatted from a printf-style format
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 7
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation" // Context longer than a frame is cut on purpose
+#endif
+PRINTF_FORMAT(2, 3) C_RESULT_API ResultCode result_wrapf(Result *result, const char *format, ...)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!result || !format) {
+        return ERR_NULL_POINTER;
+    }
+#ifdef C_RESULT_NO_MESSAGES
+    return SUCCESS;
+#else
+    if (is_result_success(*result)) {
+        return SUCCESS;
+    }
+    ResultContextFrame *frame = c_result_context_push(result);
+    if (!frame) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    va_list args;
+    va_start(args, format);
+    if (vsnprintf(frame->text, sizeof(frame->text), format, args) < 0) {
+        frame->text[0] = '\0';
+    }
+    va_end(args);
+    return SUCCESS;
+#endif
+}
+#else
+;
+#endif
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 7
+#pragma GCC diagnostic pop
+#endif
+
+// Appends text to the string of length characters in buffer, as far as it fits. Returns the untruncated length.
+static inline size_t c_result_append(char *buffer, const size_t capacity, const size_t length, const char *text) {
+    const size_t size = strlen(text);
+    if (length < capacity) {
+        const size_t room = capacity - 1 - length;
+        const size_t copied = size < room ? size : room;
+        memcpy(buffer + length, text, copied);
+        buffer[length + copied] = '\0';
+    }
+    return length + size;
+}
+
+// Renders the context chain of an error into buffer, newest context first, then the message of the wrapped
+// error: "Loading the configuration: Reading 'app.conf': File not found". Like snprintf(), the text is truncated
+// to capacity - 1 characters and always terminated, and the returned length is the one of the whole text, so a
+// NULL buffer with a capacity of 0 measures it. Results without context render as their message.
+C_RESULT_API size_t result_format_chain(const Result *result, char *buffer, const size_t capacity)
+#ifdef C_RESULT_DEFINITIONS
+{
+    size_t length = 0;
+    while (!is_result_success(*result) && result->message_storage == RESULT_MESSAGE_CONTEXT) {
+        const ResultContextFrame *frame = result->data.context;
+        for (;; frame = frame->next) {
+            length = c_result_append(buffer, capacity, length, frame->text);
+            length = c_result_append(buffer, capacity, length, ": ");
+            if (!frame->next) {
+                break;
+            }
+        }
+        result = &frame->cause;
+    }
+    return c_result_append(buffer, capacity, length, result_get_error_message(result));
+}
+#else
+;
+#endif
+
 // Helper function to check if result owns memory
 static inline bool result_owns_memory(const Result *result) {
     return result->owns_memory;
@@ -446,4 +2192,118 @@ static inline void result_transfer_ownership(Result *result, bool transfer_owner
     result->owns_memory = transfer_ownership;
 }
 
+// Ownership transfer of owned payloads: the payload is returned and the result stops owning it, in one step.
+// They return NULL for errors, other value types, borrowed and shared payloads.
+// Payloads tagged with an allocator (see result_set_allocator()) must be given back to that allocator.
+
+static inline void *result_take_ptr(Result *result) {
+    if (!is_result_success(*result) || result->value_type != RESULT_TYPE_POINTER || !result->owns_memory ||
+        (result->flags & RESULT_FLAG_SHARED)) {
+        return NULL;
+    }
+    result->owns_memory = false;
+    return result->data.value.pointer;
+}
+
+static inline char *result_take_string(Result *result) {
+    if (!is_result_success(*result) || result->value_type != RESULT_TYPE_STRING || !result->owns_memory ||
+        (result->flags & RESULT_FLAG_SHARED)) {
+        return NULL;
+    }
+    result->owns_memory = false;
+    return result->data.value.string;
+}
+
+// Also returns the destructor of the payload through destructor, when not NULL
+static inline void *result_take_custom(Result *result, CustomDestructor *destructor) {
+    if (!is_result_success(*result) || result->value_type != RESULT_TYPE_CUSTOM || !result->owns_memory ||
+        (result->flags & RESULT_FLAG_SHARED)) {
+        return NULL;
+    }
+    result->owns_memory = false;
+#ifdef C_RESULT_COMPACT
+    if (result->flags & RESULT_FLAG_CUSTOM_BOXED) {
+        ResultCustom *boxed = result->data.value.custom.boxed;
+        result->data.value.custom.data = boxed->data;
+        result->flags &= (uint8_t) ~RESULT_FLAG_CUSTOM_BOXED;
+        if (destructor) {
+            *destructor = boxed->destructor;
+        }
+        C_RESULT_FREE(boxed);
+        return result->data.value.custom.data;
+    }
+    if (destructor) {
+        *destructor = NULL;
+    }
+#else
+    if (destructor) {
+        *destructor = result->data.value.custom.destructor;
+    }
+#endif
+    return result->data.value.custom.data;
+}
+
+// Combinators for chaining fallible steps in place. They take and return the result by pointer, so an error
+// travels down the chain without being copied, and its message is never re-allocated.
+
+// Transforms a success value in place
+typedef void (*ResultMapFn)(Result *value, void *context);
+// Produces the next result from a success value. The value is freed afterwards: to move its memory into
+// the next result, clear its ownership with result_transfer_ownership(value, false).
+typedef Result (*ResultBindFn)(Result *value, void *context);
+// Produces a result from an error, e.g. a fallback value. The error is freed afterwards.
+typedef Result (*ResultRecoverFn)(Result *error, void *context);
+
+// Applies fn to a success value, leaves errors untouched
+static inline Result *result_map(Result *result, const ResultMapFn fn, void *context) {
+    if (is_result_success(*result)) {
+        fn(result, context);
+    }
+    return result;
+}
+
+// Replaces a success value with fn(value), leaves errors untouched
+static inline Result *result_and_then(Result *result, const ResultBindFn fn, void *context) {
+    if (is_result_success(*result)) {
+        const Result next = fn(result, context);
+        free_result(result);
+        *result = next;
+    }
+    return result;
+}
+
+// Replaces an error with fn(error), leaves success values untouched
+static inline Result *result_or_else(Result *result, const ResultRecoverFn fn, void *context) {
+    if (!is_result_success(*result)) {
+        const Result next = fn(result, context);
+        free_result(result);
+        *result = next;
+    }
+    return result;
+}
+
+// Early return: evaluates expr and returns it from the enclosing function if it is an error.
+// A success value is freed; use RESULT_TRY_ASSIGN() to keep it.
+#define RESULT_TRY(expr) \
+    do { \
+        Result c_result_try_ = (expr); \
+        if (!is_result_success(c_result_try_)) { \
+            return c_result_try_; \
+        } \
+        free_result(&c_result_try_); \
+    } while (0)
+
+// Early return: assigns expr to the Result lvalue target and returns it from the enclosing function if it is an error
+#define RESULT_TRY_ASSIGN(target, expr) \
+    do { \
+        (target) = (expr); \
+        if (!is_result_success(target)) { \
+            return (target); \
+        } \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // C_RESULT_H
@@ -0,0 +1,234 @@
+#ifndef C_RESULT_HPP
+#define C_RESULT_HPP
+
+// C++ wrapper of c_result.h: c_result::Result owns a ::Result and frees it when it goes out of scope.
+// It is move-only, so a result has exactly one owner: moving steals the payload and leaves the source in the shell
+// state of free_result(), copying requires an explicit clone(). It is the size of a ::Result and returning it by
+// value is subject to NRVO and copy elision like any C++ object.
+// Requires C++17. From C++20 on, scalar results are constexpr and results owning nothing are destroyed without a
+// call into free_result().
+#include <cstddef>
+#include <utility>
+
+#include "c_result.h"
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) < 201703L
+#error "c_result.hpp requires C++17"
+#endif
+
+// Branch hints, C++20 attributes
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(likely) && __has_cpp_attribute(unlikely) && \
+    (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+#define C_RESULT_LIKELY [[likely]]
+#define C_RESULT_UNLIKELY [[unlikely]]
+#endif
+#endif
+#ifndef C_RESULT_LIKELY
+#define C_RESULT_LIKELY
+#define C_RESULT_UNLIKELY
+#endif
+
+// constexpr construction needs C++20 designated initializers of the value union. Statistics count every created
+// result at run time, so they rule it out.
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L && !defined(C_RESULT_STATS)
+#define C_RESULT_CONSTEXPR constexpr
+#define C_RESULT_SCALAR_(tag, member, value, factory) \
+    ::Result{.code = SUCCESS, .value_type = tag, .owns_memory = false, .message_storage = RESULT_MESSAGE_NONE, \
+             .flags = 0, .data = {.value = {.member = value}}}
+#else
+#define C_RESULT_CONSTEXPR
+#define C_RESULT_SCALAR_(tag, member, value, factory) factory(value)
+#endif
+
+namespace c_result {
+
+class [[nodiscard]] Result {
+public:
+    // Shell result: an ERR_INVALID_STATE error owning nothing, like a moved-from result
+    C_RESULT_CONSTEXPR Result() noexcept : raw_() {
+        make_shell(raw_);
+    }
+
+    // Takes ownership of a result made by the C API, e.g. Result(make_error(ERR_TIMEOUT, message)). A named raw
+    // result must be moved in, Result(std::move(raw)), and is left a shell so that freeing it as well is safe.
+    C_RESULT_CONSTEXPR explicit Result(::Result &&raw) noexcept : raw_(raw) {
+        make_shell(raw);
+    }
+
+    // Scalar successes, with the type tags make_success() picks in C
+    C_RESULT_CONSTEXPR Result(const char value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_CHAR, char_val, value, make_success_char)) {}
+    C_RESULT_CONSTEXPR Result(const signed char value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_INT8, int8_val, value, make_success_int8)) {}
+    C_RESULT_CONSTEXPR Result(const unsigned char value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_UINT8, uint8_val, value, make_success_uint8)) {}
+    C_RESULT_CONSTEXPR Result(const short value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_SHORT, short_val, value, make_success_short)) {}
+    C_RESULT_CONSTEXPR Result(const unsigned short value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_UINT16, uint16_val, value, make_success_uint16)) {}
+    C_RESULT_CONSTEXPR Result(const int value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_INT, int_val, value, make_success_int)) {}
+    C_RESULT_CONSTEXPR Result(const unsigned int value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_UINT, uint_val, value, make_success_uint)) {}
+    C_RESULT_CONSTEXPR Result(const long value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_LONG, long_val, value, make_success_long)) {}
+    C_RESULT_CONSTEXPR Result(const unsigned long value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_ULONG, ulong_val, value, make_success_ulong)) {}
+    C_RESULT_CONSTEXPR Result(const long long value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_INT64, int64_val, value, make_success_int64)) {}
+    C_RESULT_CONSTEXPR Result(const unsigned long long value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_UINT64, uint64_val, value, make_success_uint64)) {}
+    C_RESULT_CONSTEXPR Result(const float value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_FLOAT, float_val, value, make_success_float)) {}
+    C_RESULT_CONSTEXPR Result(const double value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_DOUBLE, double_val, value, make_success_double)) {}
+    C_RESULT_CONSTEXPR Result(const bool value) noexcept
+        : raw_(C_RESULT_SCALAR_(RESULT_TYPE_BOOL, bool_val, value, make_success_bool)) {}
+
+    // Pointers would silently convert to bool, use ptr() and string() instead
+    template <typename T>
+    Result(T *) = delete;
+
+    Result(const Result &) = delete;
+    Result &operator=(const Result &) = delete;
+
+    // Steals the payload of other, leaving it a shell
+    C_RESULT_CONSTEXPR Result(Result &&other) noexcept : raw_(other.raw_) {
+        make_shell(other.raw_);
+    }
+
+    C_RESULT_CONSTEXPR Result &operator=(Result &&other) noexcept {
+        if (this != &other) {
+            reset();
+            raw_ = other.raw_;
+            make_shell(other.raw_);
+        }
+        return *this;
+    }
+
+    C_RESULT_CONSTEXPR ~Result() {
+        reset();
+    }
+
+    // Pointer and string successes, owning the pointee when ownership is true
+    static Result ptr(void *value, const bool ownership) noexcept {
+        return Result(make_success_ptr(value, ownership));
+    }
+
+    static Result string(char *value, const bool ownership) noexcept {
+        return Result(make_success_string(value, ownership));
+    }
+
+    // Error with a copy of message, see make_error()
+    static Result error(const ResultCode code, const char *message) noexcept {
+        return Result(make_error(code, message));
+    }
+
+    // Error borrowing a message with static storage duration, see make_error_static()
+    static Result error_static(const ResultCode code, const char *message) noexcept {
+        return Result(make_error_static(code, message));
+    }
+
+    [[nodiscard]] constexpr bool ok() const noexcept {
+        return raw_.code == SUCCESS;
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return ok();
+    }
+
+    [[nodiscard]] constexpr ResultCode code() const noexcept {
+        return raw_.code;
+    }
+
+    [[nodiscard]] constexpr ResultValueType value_type() const noexcept {
+        return static_cast<ResultValueType>(raw_.value_type);
+    }
+
+    // Valid as long as this result is, see result_get_error_message()
+    [[nodiscard]] const char *message() const noexcept {
+        return result_get_error_message(&raw_);
+    }
+
+    // The wrapped result, for the C API. Functions moving out of it, e.g. result_channel_send(), leave a shell.
+    [[nodiscard]] ::Result *get() noexcept {
+        return &raw_;
+    }
+
+    [[nodiscard]] const ::Result *get() const noexcept {
+        return &raw_;
+    }
+
+    // Gives up ownership: the caller must free the returned result, this one is left a shell
+    [[nodiscard]] ::Result release() noexcept {
+        const ::Result raw = raw_;
+        make_shell(raw_);
+        return raw;
+    }
+
+    // Frees the payload now, leaving a shell
+    C_RESULT_CONSTEXPR void reset() noexcept {
+        if (raw_.owns_memory || (raw_.flags & RESULT_FLAG_CUSTOM_BOXED)) C_RESULT_UNLIKELY {
+            free_result(&raw_);
+        } else {
+            make_shell(raw_);
+        }
+    }
+
+    // Adds context to an error, see result_wrap()
+    ResultCode wrap(const char *context) noexcept {
+        return result_wrap(&raw_, context);
+    }
+
+    // Copy of the result, see result_clone()
+    [[nodiscard]] Result clone() const noexcept {
+        return Result(result_clone(&raw_));
+    }
+
+    // Typed reads, true and out set when the result is a success holding that type, see result_get()
+    bool read(char &out) const noexcept { return c_result_get_char(&raw_, &out); }
+    bool read(signed char &out) const noexcept { return c_result_get_schar(&raw_, &out); }
+    bool read(unsigned char &out) const noexcept { return c_result_get_uchar(&raw_, &out); }
+    bool read(short &out) const noexcept { return c_result_get_short(&raw_, &out); }
+    bool read(unsigned short &out) const noexcept { return c_result_get_ushort(&raw_, &out); }
+    bool read(int &out) const noexcept { return c_result_get_int(&raw_, &out); }
+    bool read(unsigned int &out) const noexcept { return c_result_get_uint(&raw_, &out); }
+    bool read(long &out) const noexcept { return c_result_get_long(&raw_, &out); }
+    bool read(unsigned long &out) const noexcept { return c_result_get_ulong(&raw_, &out); }
+    bool read(long long &out) const noexcept { return c_result_get_llong(&raw_, &out); }
+    bool read(unsigned long long &out) const noexcept { return c_result_get_ullong(&raw_, &out); }
+    bool read(float &out) const noexcept { return c_result_get_float(&raw_, &out); }
+    bool read(double &out) const noexcept { return c_result_get_double(&raw_, &out); }
+    bool read(bool &out) const noexcept { return c_result_get_bool(&raw_, &out); }
+    bool read(void *&out) const noexcept { return c_result_get_ptr(&raw_, &out); }
+    bool read(char *&out) const noexcept { return c_result_get_string(&raw_, &out); }
+
+    // Value of the result, or fallback when it is an error or holds another type
+    template <typename T>
+    [[nodiscard]] T value_or(const T fallback) const noexcept {
+        T out;
+        if (read(out)) C_RESULT_LIKELY {
+            return out;
+        }
+        return fallback;
+    }
+
+private:
+    static C_RESULT_CONSTEXPR void make_shell(::Result &raw) noexcept {
+        raw.code = ERR_INVALID_STATE;
+        raw.owns_memory = false;
+        raw.message_storage = RESULT_MESSAGE_NONE;
+        raw.flags = 0;
+    }
+
+    ::Result raw_;
+};
+
+static_assert(sizeof(Result) == sizeof(::Result), "c_result::Result must be the size of a Result");
+
+} // namespace c_result
+
+#undef C_RESULT_SCALAR_
+
+#endif // C_RESULT_HPP
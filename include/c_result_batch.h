@@ -0,0 +1,409 @@
+#ifndef C_RESULT_BATCH_H
+#define C_RESULT_BATCH_H
+
+#include "c_result.h"
+
+// SIMD kernels for scanning code arrays, disabled with C_RESULT_NO_SIMD
+#if !defined(C_RESULT_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define C_RESULT_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define C_RESULT_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define C_RESULT_SIMD_NEON
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Batch of results stored as a structure of arrays.
+// Scanning the codes of a batch only touches the contiguous code array, instead of striding over whole Results.
+// The batch owns the memory of the results pushed into it; result_batch_get() returns borrowed views.
+typedef struct {
+    ResultCode *codes;
+    uint8_t *value_types; // ResultValueType
+    bool *owns_memory;
+    uint8_t *message_storage; // ResultMessageStorage
+    uint8_t *flags; // RESULT_FLAG_* bits
+    uint64_t *payloads; // First word of the value union
+    char **messages;
+    CustomDestructor *destructors; // Allocated by the first push of a custom value with a destructor
+    size_t count;
+    size_t capacity;
+    size_t owned_count; // Number of entries owning memory, clearing the batch skips the scan when zero
+} ResultBatch;
+
+C_RESULT_STATIC_ASSERT(sizeof(((Result *) 0)->data.value) >= sizeof(uint64_t), "Payload word must fit the value union");
+
+// Grows every array of the batch to hold at least capacity entries, returns SUCCESS or ERR_OUT_OF_MEMORY
+C_RESULT_API ResultCode result_batch_reserve(ResultBatch *batch, const size_t capacity)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (capacity <= batch->capacity) {
+        return SUCCESS;
+    }
+
+    // Arrays are grown one at a time; an array that grew before a failure simply keeps its extra room
+#define C_RESULT_BATCH_GROW_(array) \
+    do { \
+        void *grown = C_RESULT_REALLOC(batch->array, capacity * sizeof(*batch->array)); \
+        if (!grown) return ERR_OUT_OF_MEMORY; \
+        memcpy(&batch->array, &grown, sizeof(grown)); \
+    } while (0)
+    C_RESULT_BATCH_GROW_(codes);
+    C_RESULT_BATCH_GROW_(value_types);
+    C_RESULT_BATCH_GROW_(owns_memory);
+    C_RESULT_BATCH_GROW_(message_storage);
+    C_RESULT_BATCH_GROW_(flags);
+    C_RESULT_BATCH_GROW_(payloads);
+    C_RESULT_BATCH_GROW_(messages);
+    if (batch->destructors) {
+        C_RESULT_BATCH_GROW_(destructors);
+        memset(batch->destructors + batch->capacity, 0, (capacity - batch->capacity) * sizeof(*batch->destructors));
+    }
+#undef C_RESULT_BATCH_GROW_
+
+    batch->capacity = capacity;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Initializes an empty batch with room for capacity entries, returns SUCCESS or ERR_OUT_OF_MEMORY
+static inline ResultCode result_batch_init(ResultBatch *batch, const size_t capacity) {
+    memset(batch, 0, sizeof(*batch));
+    return result_batch_reserve(batch, capacity);
+}
+
+static inline size_t result_batch_count(const ResultBatch *batch) {
+    return batch->count;
+}
+
+static inline ResultCode result_batch_code(const ResultBatch *batch, const size_t index) {
+    return batch->codes[index];
+}
+
+// Writes a result into the slot at index (below the capacity), without updating count and owned_count.
+// The batch takes ownership of its memory, even when this fails.
+// Inline messages are copied to the heap, since the batch has no inline storage.
+static inline ResultCode c_result_batch_store(ResultBatch *batch, const size_t index, Result result) {
+    if (!is_result_success(result) && result.message_storage == RESULT_MESSAGE_INLINE) {
+        const size_t size = strlen(result.data.inline_message) + 1;
+        char *message = (char *) C_RESULT_MALLOC(size);
+        if (!message) {
+            return ERR_OUT_OF_MEMORY;
+        }
+        memcpy(message, result.data.inline_message, size);
+        result.data.message = message;
+        result.message_storage = RESULT_MESSAGE_HEAP;
+        result.owns_memory = true;
+        result_set_allocator(&result, RESULT_ALLOCATOR_DEFAULT);
+    }
+
+#ifndef C_RESULT_COMPACT
+    if (is_result_success(result) && result.value_type == RESULT_TYPE_CUSTOM && result.data.value.custom.destructor) {
+        if (!batch->destructors) {
+            batch->destructors = (CustomDestructor *) C_RESULT_MALLOC(batch->capacity * sizeof(*batch->destructors));
+            if (!batch->destructors) {
+                free_result(&result);
+                return ERR_OUT_OF_MEMORY;
+            }
+            memset(batch->destructors, 0, batch->capacity * sizeof(*batch->destructors));
+        }
+        batch->destructors[index] = result.data.value.custom.destructor;
+    } else if (batch->destructors) {
+        batch->destructors[index] = NULL;
+    }
+#endif
+
+    batch->codes[index] = result.code;
+    batch->value_types[index] = (uint8_t) result.value_type;
+    batch->owns_memory[index] = result.owns_memory;
+    batch->message_storage[index] = result.message_storage;
+    batch->flags[index] = result.flags;
+    if (is_result_success(result)) {
+        memcpy(&batch->payloads[index], &result.data.value, sizeof(uint64_t));
+        batch->messages[index] = NULL;
+    } else if (result.message_storage == RESULT_MESSAGE_ERRNO || result.message_storage == RESULT_MESSAGE_WIN32) {
+        batch->payloads[index] = result.data.os_error; // OS errors keep their code in the payload word
+        batch->messages[index] = NULL;
+    } else if (result.message_storage == RESULT_MESSAGE_CONTEXT) {
+        batch->payloads[index] = (uint64_t) (uintptr_t) result.data.context; // So does the chain of a wrapped error
+        batch->messages[index] = NULL;
+    } else {
+        batch->payloads[index] = 0;
+        batch->messages[index] = result.message_storage == RESULT_MESSAGE_NONE ? NULL : result.data.message;
+    }
+    return SUCCESS;
+}
+
+// Whether the entry at index owns memory, for owned_count
+static inline bool c_result_batch_owned(const ResultBatch *batch, const size_t index) {
+    return batch->owns_memory[index] || (batch->flags[index] & RESULT_FLAG_CUSTOM_BOXED);
+}
+
+// Moves a result into the batch. The batch takes ownership of its memory, even when the push fails.
+// Inline messages are copied to the heap, since the batch has no inline storage.
+static inline ResultCode result_batch_push(ResultBatch *batch, Result result) {
+    if (batch->count == batch->capacity &&
+        result_batch_reserve(batch, batch->capacity ? batch->capacity * 2 : 16) != SUCCESS) {
+        free_result(&result);
+        return ERR_OUT_OF_MEMORY;
+    }
+    const ResultCode code = c_result_batch_store(batch, batch->count, result);
+    if (code != SUCCESS) {
+        return code;
+    }
+    batch->owned_count += c_result_batch_owned(batch, batch->count);
+    batch->count++;
+    return SUCCESS;
+}
+
+// Pushes an error borrowing a message with static storage duration
+static inline ResultCode result_batch_push_error(ResultBatch *batch, const ResultCode code, const char *message) {
+    return result_batch_push(batch, make_error_static(code, message));
+}
+
+static inline ResultCode result_batch_push_int(ResultBatch *batch, const int value) {
+    return result_batch_push(batch, make_success_int(value));
+}
+
+static inline ResultCode result_batch_push_int64(ResultBatch *batch, const int64_t value) {
+    return result_batch_push(batch, make_success_int64(value));
+}
+
+static inline ResultCode result_batch_push_double(ResultBatch *batch, const double value) {
+    return result_batch_push(batch, make_success_double(value));
+}
+
+static inline ResultCode result_batch_push_ptr(ResultBatch *batch, void *value, const bool ownership) {
+    return result_batch_push(batch, make_success_ptr(value, ownership));
+}
+
+static inline ResultCode result_batch_push_string(ResultBatch *batch, char *value, const bool ownership) {
+    return result_batch_push(batch, make_success_string(value, ownership));
+}
+
+// Rebuilds the full result at index, including ownership
+static inline Result c_result_batch_entry(const ResultBatch *batch, const size_t index) {
+    Result res = C_RESULT_INIT;
+    res.code = batch->codes[index];
+    res.value_type = (ResultValueType) batch->value_types[index];
+    res.owns_memory = batch->owns_memory[index];
+    res.message_storage = batch->message_storage[index];
+    res.flags = batch->flags[index];
+    if (is_result_success(res)) {
+        memcpy(&res.data.value, &batch->payloads[index], sizeof(uint64_t));
+#ifndef C_RESULT_COMPACT
+        if (res.value_type == RESULT_TYPE_CUSTOM && batch->destructors) {
+            res.data.value.custom.destructor = batch->destructors[index];
+        }
+#endif
+    } else if (res.message_storage == RESULT_MESSAGE_ERRNO || res.message_storage == RESULT_MESSAGE_WIN32) {
+        res.data.os_error = (uint32_t) batch->payloads[index];
+    } else if (res.message_storage == RESULT_MESSAGE_CONTEXT) {
+        res.data.context = (ResultContextFrame *) (uintptr_t) batch->payloads[index];
+    } else {
+        res.data.message = batch->messages[index];
+    }
+    return res;
+}
+
+// Borrowed view of the result at index: the batch keeps ownership, so free_result() on it does nothing
+static inline Result result_batch_get(const ResultBatch *batch, const size_t index) {
+    Result res = c_result_batch_entry(batch, index);
+    res.owns_memory = false;
+#ifdef C_RESULT_COMPACT
+    if (res.flags & RESULT_FLAG_CUSTOM_BOXED) {
+        res.data.value.custom.data = res.data.value.custom.boxed->data;
+        res.flags &= (uint8_t) ~RESULT_FLAG_CUSTOM_BOXED;
+    }
+#endif
+    return res;
+}
+
+// Frees every entry in one pass over the ownership array and empties the batch, keeping its capacity
+C_RESULT_API void result_batch_clear(ResultBatch *batch)
+#ifdef C_RESULT_DEFINITIONS
+{
+    for (size_t i = 0; batch->owned_count && i < batch->count; i++) {
+        if (batch->owns_memory[i] || (batch->flags[i] & RESULT_FLAG_CUSTOM_BOXED)) {
+            Result res = c_result_batch_entry(batch, i);
+            free_result(&res);
+            batch->owned_count--;
+        }
+    }
+    batch->count = 0;
+    batch->owned_count = 0;
+}
+#else
+;
+#endif
+
+// Frees every entry and the arrays of the batch
+C_RESULT_API void result_batch_free_all(ResultBatch *batch)
+#ifdef C_RESULT_DEFINITIONS
+{
+    result_batch_clear(batch);
+    C_RESULT_FREE(batch->codes);
+    C_RESULT_FREE(batch->value_types);
+    C_RESULT_FREE(batch->owns_memory);
+    C_RESULT_FREE(batch->message_storage);
+    C_RESULT_FREE(batch->flags);
+    C_RESULT_FREE(batch->payloads);
+    C_RESULT_FREE(batch->messages);
+    C_RESULT_FREE(batch->destructors);
+    memset(batch, 0, sizeof(*batch));
+}
+#else
+;
+#endif
+
+// Bit i of the returned mask is set if codes[i] is SUCCESS, for the 16 codes starting at codes
+static inline uint32_t c_result_success_bits16(const ResultCode *codes) {
+#if defined(C_RESULT_SIMD_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i low = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) codes), zero);
+    const __m256i high = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (codes + 8)), zero);
+    return (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(low)) |
+           (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(high)) << 8;
+#elif defined(C_RESULT_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) codes), zero);
+    const __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (codes + 4)), zero);
+    const __m128i c = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (codes + 8)), zero);
+    const __m128i d = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (codes + 12)), zero);
+    // Narrow the 32-bit lane masks to bytes while keeping their order
+    return (uint32_t) _mm_movemask_epi8(_mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+#elif defined(C_RESULT_SIMD_NEON)
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint32x4_t a = vceqzq_s32(vld1q_s32(codes));
+    const uint32x4_t b = vceqzq_s32(vld1q_s32(codes + 4));
+    const uint32x4_t c = vceqzq_s32(vld1q_s32(codes + 8));
+    const uint32x4_t d = vceqzq_s32(vld1q_s32(codes + 12));
+    const uint8x16_t bytes = vcombine_u8(vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b))),
+                                         vmovn_u16(vcombine_u16(vmovn_u32(c), vmovn_u32(d))));
+    const uint8x16_t bits = vandq_u8(bytes, vld1q_u8(weights));
+    return (uint32_t) vaddv_u8(vget_low_u8(bits)) | (uint32_t) vaddv_u8(vget_high_u8(bits)) << 8;
+#else
+    uint32_t bits = 0;
+    for (unsigned i = 0; i < 16; i++) {
+        bits |= (uint32_t) (codes[i] == SUCCESS) << i;
+    }
+    return bits;
+#endif
+}
+
+static inline unsigned c_result_popcount32(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned) __builtin_popcount(bits);
+#else
+    unsigned count = 0;
+    for (; bits; bits &= bits - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit, bits must not be zero
+static inline unsigned c_result_lowest_bit32(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned) __builtin_ctz(bits);
+#else
+    unsigned index = 0;
+    for (; !(bits & 1u); bits >>= 1) {
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Scans over code arrays, comparing 16 codes at a time against SUCCESS (AVX2, SSE2 or NEON, with a scalar fallback)
+
+static inline bool result_codes_all_ok(const ResultCode *codes, const size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        if (c_result_success_bits16(codes + i) != 0xFFFFu) {
+            return false;
+        }
+    }
+    for (; i < count; i++) {
+        if (codes[i] != SUCCESS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline size_t result_codes_count_errors(const ResultCode *codes, const size_t count) {
+    size_t errors = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        errors += 16 - c_result_popcount32(c_result_success_bits16(codes + i));
+    }
+    for (; i < count; i++) {
+        errors += codes[i] != SUCCESS;
+    }
+    return errors;
+}
+
+// Index of the first error, or count if every code is SUCCESS
+static inline size_t result_codes_first_error(const ResultCode *codes, const size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint32_t errors = ~c_result_success_bits16(codes + i) & 0xFFFFu;
+        if (errors) {
+            return i + c_result_lowest_bit32(errors);
+        }
+    }
+    for (; i < count; i++) {
+        if (codes[i] != SUCCESS) {
+            return i;
+        }
+    }
+    return count;
+}
+
+// Sets bit i % 64 of mask[i / 64] for every error; mask must hold (count + 63) / 64 words
+static inline void result_codes_error_mask(const ResultCode *codes, const size_t count, uint64_t *mask) {
+    memset(mask, 0, (count + 63) / 64 * sizeof(uint64_t));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint64_t errors = ~c_result_success_bits16(codes + i) & 0xFFFFu;
+        mask[i / 64] |= errors << (i % 64);
+    }
+    for (; i < count; i++) {
+        mask[i / 64] |= (uint64_t) (codes[i] != SUCCESS) << (i % 64);
+    }
+}
+
+static inline bool result_batch_all_ok(const ResultBatch *batch) {
+    return result_codes_all_ok(batch->codes, batch->count);
+}
+
+static inline size_t result_batch_count_errors(const ResultBatch *batch) {
+    return result_codes_count_errors(batch->codes, batch->count);
+}
+
+// Index of the first error, or result_batch_count() if every result is a success
+static inline size_t result_batch_first_error(const ResultBatch *batch) {
+    return result_codes_first_error(batch->codes, batch->count);
+}
+
+// Bit mask of the errors in the batch; mask must hold (result_batch_count() + 63) / 64 words
+static inline void result_batch_error_mask(const ResultBatch *batch, uint64_t *mask) {
+    result_codes_error_mask(batch->codes, batch->count, mask);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_BATCH_H
@@ -0,0 +1,131 @@
+#ifndef C_RESULT_CHANNEL_H
+#define C_RESULT_CHANNEL_H
+
+#include "c_result.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bounded lock-free multi-producer single-consumer channel of results (Vyukov ring buffer).
+// Results are moved through the channel: a successful send leaves the sender with a shell, as result_move() does,
+// and the receiver owns what it receives. Sending and receiving take no lock and make no allocation.
+
+typedef struct {
+    C_RESULT_ATOMIC(size_t) sequence; // Position the slot is ready for: written at position, read at position + 1
+    Result result;
+} ResultChannelSlot;
+
+typedef struct {
+    ResultChannelSlot *slots;
+    size_t mask; // Capacity - 1, the capacity is a power of two
+    char padding_slots[64 - sizeof(void *) - sizeof(size_t)];
+    C_RESULT_ATOMIC(size_t) head; // Next position to send to, shared by the producers
+    char padding_head[64 - sizeof(size_t)]; // Keeps the producers off the consumer's cache line
+    size_t tail; // Next position to receive from, owned by the consumer
+} ResultChannel;
+
+// Creates a channel holding at least capacity results (rounded up to a power of two)
+C_RESULT_API ResultCode result_channel_init(ResultChannel *channel, const size_t capacity)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!channel) {
+        return ERR_NULL_POINTER;
+    }
+    size_t size = 2;
+    while (size < capacity) {
+        if (size > SIZE_MAX / 2 / sizeof(ResultChannelSlot)) {
+            return ERR_OUT_OF_RANGE;
+        }
+        size *= 2;
+    }
+    memset(channel, 0, sizeof(*channel));
+    channel->slots = (ResultChannelSlot *) C_RESULT_MALLOC(size * sizeof(ResultChannelSlot));
+    if (!channel->slots) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < size; i++) {
+        c_result_atomic_init(&channel->slots[i].sequence, i);
+    }
+    channel->mask = size - 1;
+    c_result_atomic_init(&channel->head, 0);
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Moves a result into the channel, from any thread. On success the result is left as a shell. When the channel is
+// full it returns ERR_NO_SPACE and the caller keeps ownership and may retry.
+// A message in the sender's thread arena is copied to the heap first, since it would dangle once the sender resets
+// its arena; ERR_OUT_OF_MEMORY when that copy fails.
+WARN_UNUSED_RESULT static inline ResultCode result_channel_send(ResultChannel *channel, Result *result) {
+    if (c_result_detach_message(result) != SUCCESS) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    size_t position = c_result_atomic_load(&channel->head, C_RESULT_RELAXED);
+    ResultChannelSlot *slot;
+    for (;;) {
+        slot = &channel->slots[position & channel->mask];
+        const size_t sequence = c_result_atomic_load(&slot->sequence, C_RESULT_ACQUIRE);
+        if (sequence == position) {
+            if (c_result_atomic_compare_exchange(&channel->head, &position, position + 1, C_RESULT_RELAXED)) {
+                break;
+            }
+        } else if ((intptr_t) (sequence - position) < 0) {
+            return ERR_NO_SPACE; // The consumer has not received this slot of the previous lap yet
+        } else {
+            position = c_result_atomic_load(&channel->head, C_RESULT_RELAXED);
+        }
+    }
+    result_move(&slot->result, result);
+    c_result_atomic_store(&slot->sequence, position + 1, C_RESULT_RELEASE);
+    return SUCCESS;
+}
+
+// Receives up to capacity results into results, in send order. Consumer thread only.
+// Returns the number of results received; the caller owns them and frees them with free_result().
+static inline size_t result_channel_drain(ResultChannel *channel, Result *results, const size_t capacity) {
+    size_t count = 0;
+    size_t position = channel->tail;
+    while (count < capacity) {
+        ResultChannelSlot *slot = &channel->slots[position & channel->mask];
+        if (c_result_atomic_load(&slot->sequence, C_RESULT_ACQUIRE) != position + 1) {
+            break; // Empty, or the producer that claimed this slot has not finished writing it
+        }
+        results[count++] = slot->result;
+        c_result_atomic_store(&slot->sequence, position + channel->mask + 1, C_RESULT_RELEASE);
+        position++;
+    }
+    channel->tail = position;
+    return count;
+}
+
+// Receives one result, returns false when the channel is empty. Consumer thread only.
+static inline bool result_channel_receive(ResultChannel *channel, Result *result) {
+    return result_channel_drain(channel, result, 1) == 1;
+}
+
+// Frees the results still in the channel, then the channel itself. No thread may use the channel concurrently.
+C_RESULT_API void result_channel_destroy(ResultChannel *channel)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!channel || !channel->slots) {
+        return;
+    }
+    Result result;
+    while (result_channel_receive(channel, &result)) {
+        free_result(&result);
+    }
+    C_RESULT_FREE(channel->slots);
+    channel->slots = NULL;
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_CHANNEL_H
@@ -0,0 +1,269 @@
+#ifndef C_RESULT_FUTURE_H
+#define C_RESULT_FUTURE_H
+
+// A strict -std=c99/c11 hides clock_gettime(), CLOCK_MONOTONIC and pthread_condattr_setclock(): ask for POSIX.1-2008
+// when this header is included first. GNU modes see them already, and defining the macro there would hide the
+// BSD and System V extensions the rest of the program may use.
+#if !defined(_WIN32) && defined(__STRICT_ANSI__)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#endif
+
+#include "c_result.h"
+
+// Futures: a Result that completes later, e.g. when an event loop sees the I/O finish.
+// The ResultFuture holds the Result in place, so completing, polling and waiting make no allocation. A
+// ResultPromise is the completing side of a future; completion moves a Result in and runs the completion callback,
+// if one was registered. Blocking waits use a mutex and a condition variable, which the completing side only
+// touches when a thread is actually waiting.
+//
+// On POSIX systems this header needs pthreads: link with -pthread. Timed waits use CLOCK_MONOTONIC; when a system
+// header included earlier fixed a feature set without it, they fall back to the C11 realtime clock.
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#if defined(CLOCK_MONOTONIC) && !defined(__APPLE__)
+#define C_RESULT_FUTURE_MONOTONIC
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Future state bits
+#define RESULT_FUTURE_PENDING 0x0
+#define RESULT_FUTURE_CALLBACK 0x1 // A completion callback is registered
+#define RESULT_FUTURE_COMPLETING 0x2 // A promise claimed the completion and is moving the Result in
+#define RESULT_FUTURE_COMPLETE 0x4 // The Result is available
+
+typedef struct ResultFuture ResultFuture;
+
+// Completion callback, called once, in the thread that completes the future (or registers the callback, when the
+// future is already complete). It may take the Result with result_future_get().
+typedef void (*ResultFutureCallback)(ResultFuture *future, void *context);
+
+struct ResultFuture {
+    C_RESULT_ATOMIC(uint32_t) state; // RESULT_FUTURE_* bits
+    C_RESULT_ATOMIC(uint32_t) waiters; // Threads blocked in result_future_wait()
+    Result result;
+    ResultFutureCallback callback;
+    void *context;
+#if defined(_WIN32)
+    SRWLOCK lock;
+    CONDITION_VARIABLE condition;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t condition;
+#endif
+};
+
+// Completing side of a future
+typedef struct {
+    ResultFuture *future;
+} ResultPromise;
+
+// Initializes a pending future
+C_RESULT_API ResultCode result_future_init(ResultFuture *future)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!future) {
+        return ERR_NULL_POINTER;
+    }
+    memset(future, 0, sizeof(*future));
+    c_result_atomic_init(&future->state, RESULT_FUTURE_PENDING);
+    c_result_atomic_init(&future->waiters, 0);
+    c_result_make_shell(&future->result);
+#if defined(_WIN32)
+    InitializeSRWLock(&future->lock);
+    InitializeConditionVariable(&future->condition);
+#else
+    pthread_condattr_t attributes;
+    if (pthread_condattr_init(&attributes) != 0) {
+        return ERR_UNKNOWN;
+    }
+#ifdef C_RESULT_FUTURE_MONOTONIC
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+#endif
+    if (pthread_mutex_init(&future->lock, NULL) != 0) {
+        pthread_condattr_destroy(&attributes);
+        return ERR_UNKNOWN;
+    }
+    if (pthread_cond_init(&future->condition, &attributes) != 0) {
+        pthread_condattr_destroy(&attributes);
+        pthread_mutex_destroy(&future->lock);
+        return ERR_UNKNOWN;
+    }
+    pthread_condattr_destroy(&attributes);
+#endif
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Frees the Result if it was not taken, and the synchronization objects. No thread may use the future concurrently.
+C_RESULT_API void result_future_destroy(ResultFuture *future)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!future) {
+        return;
+    }
+    if (c_result_atomic_load(&future->state, C_RESULT_ACQUIRE) & RESULT_FUTURE_COMPLETE) {
+        free_result(&future->result);
+    }
+#if !defined(_WIN32)
+    pthread_cond_destroy(&future->condition);
+    pthread_mutex_destroy(&future->lock);
+#endif
+}
+#else
+;
+#endif
+
+static inline ResultPromise result_future_promise(ResultFuture *future) {
+    ResultPromise promise = {future};
+    return promise;
+}
+
+// Returns true once the future is complete, without blocking
+static inline bool result_future_poll(const ResultFuture *future) {
+    return (c_result_atomic_load(&((ResultFuture *) future)->state, C_RESULT_ACQUIRE) & RESULT_FUTURE_COMPLETE) != 0;
+}
+
+// Takes the Result of a complete future, leaving a shell in its place.
+// Returns an ERR_INVALID_STATE error while the future is pending.
+WARN_UNUSED_RESULT static inline Result result_future_get(ResultFuture *future) {
+    if (!result_future_poll(future)) {
+        return make_error_static(ERR_INVALID_STATE, "Future is not complete");
+    }
+    Result result;
+    result_move(&result, &future->result);
+    return result;
+}
+
+// Registers the completion callback, which runs right away when the future is already complete.
+// A future has at most one callback: ERR_ALREADY_EXISTS when one is registered. Registration is not meant to race
+// with another registration, only with completion.
+static inline ResultCode result_future_on_complete(ResultFuture *future, const ResultFutureCallback callback,
+                                                   void *context) {
+    if (!callback) {
+        return ERR_NULL_POINTER;
+    }
+    if (c_result_atomic_load(&future->state, C_RESULT_ACQUIRE) & RESULT_FUTURE_CALLBACK) {
+        return ERR_ALREADY_EXISTS;
+    }
+    future->callback = callback;
+    future->context = context;
+    // Whichever of the registration and the completion comes second runs the callback
+    if (c_result_atomic_fetch_or(&future->state, RESULT_FUTURE_CALLBACK, C_RESULT_ACQ_REL) & RESULT_FUTURE_COMPLETE) {
+        callback(future, context);
+    }
+    return SUCCESS;
+}
+
+// Completes the future, moving result into it (result is left as a shell), then runs the callback and wakes
+// waiting threads. Returns ERR_INVALID_STATE, leaving result untouched, when the future was already completed.
+C_RESULT_API ResultCode result_promise_complete(const ResultPromise promise, Result *result)
+#ifdef C_RESULT_DEFINITIONS
+{
+    ResultFuture *future = promise.future;
+    if (c_result_atomic_fetch_or(&future->state, RESULT_FUTURE_COMPLETING, C_RESULT_ACQ_REL) &
+        RESULT_FUTURE_COMPLETING) {
+        return ERR_INVALID_STATE;
+    }
+    result_move(&future->result, result);
+    const uint32_t state = c_result_atomic_fetch_or(&future->state, RESULT_FUTURE_COMPLETE, C_RESULT_SEQ_CST);
+
+    // Either the waiter sees COMPLETE before blocking, or we see it counted and wake it (both sides are seq_cst)
+    if (c_result_atomic_load(&future->waiters, C_RESULT_SEQ_CST)) {
+#if defined(_WIN32)
+        AcquireSRWLockExclusive(&future->lock);
+        ReleaseSRWLockExclusive(&future->lock);
+        WakeAllConditionVariable(&future->condition);
+#else
+        pthread_mutex_lock(&future->lock);
+        pthread_cond_broadcast(&future->condition);
+        pthread_mutex_unlock(&future->lock);
+#endif
+    }
+    if (state & RESULT_FUTURE_CALLBACK) {
+        future->callback(future, future->context);
+    }
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Waits up to timeout_ms milliseconds (forever when negative) for the future to complete and takes its Result.
+// Returns an ERR_TIMEOUT error, leaving the future pending, when the timeout expires first.
+WARN_UNUSED_RESULT C_RESULT_API Result result_future_wait(ResultFuture *future, const long timeout_ms)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!result_future_poll(future) && timeout_ms != 0) {
+        c_result_atomic_fetch_add(&future->waiters, 1, C_RESULT_SEQ_CST);
+#if defined(_WIN32)
+        const ULONGLONG deadline = GetTickCount64() + (ULONGLONG) (timeout_ms > 0 ? timeout_ms : 0);
+        AcquireSRWLockExclusive(&future->lock);
+        while (!(c_result_atomic_load(&future->state, C_RESULT_SEQ_CST) & RESULT_FUTURE_COMPLETE)) {
+            DWORD wait = INFINITE;
+            if (timeout_ms > 0) {
+                const ULONGLONG now = GetTickCount64();
+                if (now >= deadline) {
+                    break;
+                }
+                wait = (DWORD) (deadline - now);
+            }
+            SleepConditionVariableSRW(&future->condition, &future->lock, wait, 0);
+        }
+        ReleaseSRWLockExclusive(&future->lock);
+#else
+        struct timespec deadline;
+#if defined(C_RESULT_FUTURE_MONOTONIC)
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+#elif defined(CLOCK_REALTIME)
+        clock_gettime(CLOCK_REALTIME, &deadline);
+#elif defined(TIME_UTC)
+        timespec_get(&deadline, TIME_UTC);
+#else
+        deadline.tv_sec = time(NULL);
+        deadline.tv_nsec = 0;
+#endif
+        if (timeout_ms > 0) {
+            deadline.tv_sec += timeout_ms / 1000;
+            deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+        }
+        pthread_mutex_lock(&future->lock);
+        while (!(c_result_atomic_load(&future->state, C_RESULT_SEQ_CST) & RESULT_FUTURE_COMPLETE)) {
+            if (timeout_ms < 0) {
+                pthread_cond_wait(&future->condition, &future->lock);
+            } else if (pthread_cond_timedwait(&future->condition, &future->lock, &deadline) != 0) {
+                break; // ETIMEDOUT
+            }
+        }
+        pthread_mutex_unlock(&future->lock);
+#endif
+        c_result_atomic_fetch_sub(&future->waiters, 1, C_RESULT_RELAXED);
+    }
+    if (!result_future_poll(future)) {
+        return make_error_static(ERR_TIMEOUT, "Timed out waiting for the future");
+    }
+    return result_future_get(future);
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_FUTURE_H
@@ -0,0 +1,229 @@
+#ifndef C_RESULT_INTERN_H
+#define C_RESULT_INTERN_H
+
+#include "c_result.h"
+
+// Interned error messages, optionally shared between processes.
+// A ResultInternTable is a lock-free open-addressing hash table of message texts laid out in one memory region,
+// followed by the texts themselves. It refers to texts by offset, never by pointer, so the region can be a
+// shared-memory segment: set up before fork(), every pre-forked worker sees the same table at the same address,
+// and each distinct message is stored once for all of them. make_error_interned() then costs one hash lookup and
+// no allocation once a message is in the table.
+// Entries are never removed; when the table is full, make_error_interned() falls back to make_error().
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define C_RESULT_INTERN_MAGIC 0x52534E49u // "INSR"
+
+// Header of the table region, followed by the slots and the text area
+typedef struct {
+    uint32_t magic;
+    uint32_t mask; // Slot count - 1, the slot count is a power of two
+    uint32_t size; // Size of the whole region
+    uint32_t texts; // Offset of the text area
+    C_RESULT_ATOMIC(uint32_t) used; // Offset of the first free text byte
+    C_RESULT_ATOMIC(uint32_t) count; // Number of interned texts
+} ResultInternTable;
+
+// Process-wide table used by make_error_interned()
+C_RESULT_GLOBAL ResultInternTable *c_result_intern_default C_RESULT_ZERO;
+
+// Slots hold the 32-bit hash of a text in the high half and its offset in the low half, 0 when empty
+static inline C_RESULT_ATOMIC(uint64_t) *c_result_intern_slots(ResultInternTable *table) {
+    return (C_RESULT_ATOMIC(uint64_t) *) (void *) ((char *) table + sizeof(uint64_t) * 3);
+}
+C_RESULT_STATIC_ASSERT(sizeof(ResultInternTable) <= sizeof(uint64_t) * 3, "Intern table header must fit 24 bytes");
+
+// Formats size bytes of (8-byte aligned) memory as an empty table with at least slots slots (rounded up to a power
+// of two). Returns SUCCESS, or ERR_NO_SPACE when the region cannot hold the slots and some text.
+C_RESULT_API ResultCode result_intern_init(void *memory, const size_t size, const size_t slots)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!memory) {
+        return ERR_NULL_POINTER;
+    }
+    size_t count = 16;
+    while (count < slots && count <= UINT32_MAX / 2) {
+        count *= 2;
+    }
+    const size_t texts = sizeof(uint64_t) * 3 + count * sizeof(uint64_t);
+    if (size > UINT32_MAX || texts >= size) {
+        return ERR_NO_SPACE;
+    }
+    ResultInternTable *table = (ResultInternTable *) memory;
+    memset(table, 0, texts);
+    table->mask = (uint32_t) (count - 1);
+    table->size = (uint32_t) size;
+    table->texts = (uint32_t) texts;
+    c_result_atomic_init(&table->used, (uint32_t) texts);
+    c_result_atomic_init(&table->count, 0);
+    for (size_t i = 0; i < count; i++) {
+        c_result_atomic_init(&c_result_intern_slots(table)[i], 0);
+    }
+    table->magic = C_RESULT_INTERN_MAGIC;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Maps a region of size bytes that child processes share after fork() and formats it, see result_intern_init().
+// On Windows the region is private to the process. Returns NULL on failure.
+C_RESULT_API ResultInternTable *result_intern_create(const size_t size, const size_t slots)
+#ifdef C_RESULT_DEFINITIONS
+{
+#if defined(_WIN32)
+    void *memory = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!memory) {
+        return NULL;
+    }
+    if (result_intern_init(memory, size, slots) != SUCCESS) {
+        VirtualFree(memory, 0, MEM_RELEASE);
+        return NULL;
+    }
+#else
+#if defined(MAP_ANONYMOUS) || defined(MAP_ANON)
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+#else
+    // Shared mapping of /dev/zero, the portable way to get anonymous shared memory
+    const int fd = open("/dev/zero", O_RDWR);
+    void *memory = fd < 0 ? MAP_FAILED : mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+    if (result_intern_init(memory, size, slots) != SUCCESS) {
+        munmap(memory, size);
+        return NULL;
+    }
+#endif
+    return (ResultInternTable *) memory;
+}
+#else
+;
+#endif
+
+// Unmaps a table created with result_intern_create(). Interned texts must no longer be in use.
+C_RESULT_API void result_intern_destroy(ResultInternTable *table)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!table) {
+        return;
+    }
+    if (c_result_intern_default == table) {
+        c_result_intern_default = NULL;
+    }
+#if defined(_WIN32)
+    VirtualFree(table, 0, MEM_RELEASE);
+#else
+    munmap(table, table->size);
+#endif
+}
+#else
+;
+#endif
+
+// Sets the table used by make_error_interned(), NULL disables interning
+static inline void result_intern_set_default(ResultInternTable *table) {
+    c_result_intern_default = table;
+}
+
+// Number of distinct texts in the table
+static inline size_t result_intern_count(ResultInternTable *table) {
+    return c_result_atomic_load(&table->count, C_RESULT_RELAXED);
+}
+
+// Returns the interned copy of text, usable in any process sharing the table for as long as the region is mapped.
+// Returns NULL when the table is full (or text is NULL). Safe to call concurrently from any thread or process.
+C_RESULT_API const char *result_intern(ResultInternTable *table, const char *text)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!table || !text || table->magic != C_RESULT_INTERN_MAGIC) {
+        return NULL;
+    }
+    // FNV-1a, measuring the text on the way
+    uint32_t hash = 2166136261u;
+    size_t length = 0;
+    for (; text[length]; length++) {
+        hash = (hash ^ (uint8_t) text[length]) * 16777619u;
+    }
+
+    char *base = (char *) table;
+    C_RESULT_ATOMIC(uint64_t) *slots = c_result_intern_slots(table);
+    uint32_t offset = 0; // Our copy of the text, once made
+    for (uint32_t probe = 0, index = hash & table->mask; probe <= table->mask;
+         probe++, index = (index + 1) & table->mask) {
+        uint64_t entry = c_result_atomic_load(&slots[index], C_RESULT_ACQUIRE);
+        for (;;) {
+            if (entry != 0) {
+                const char *interned = base + (uint32_t) entry;
+                if ((uint32_t) (entry >> 32) == hash && strcmp(interned, text) == 0) {
+                    return interned; // When we lost a race to insert the same text, our copy stays unused
+                }
+                break;
+            }
+            if (!offset) {
+                // Keep a quarter of the slots free, so that probe sequences stay short
+                if (c_result_atomic_load(&table->count, C_RESULT_RELAXED) >= (table->mask + 1) / 4 * 3 ||
+                    length >= table->size) {
+                    return NULL;
+                }
+                // Reserve the text with a CAS that never moves used past the end: giving space back after an
+                // overshoot could hand out bytes another thread or process reserved in the meantime
+                uint32_t used = c_result_atomic_load(&table->used, C_RESULT_RELAXED);
+                do {
+                    if (used > table->size || table->size - used < length + 1) {
+                        return NULL;
+                    }
+                } while (!c_result_atomic_compare_exchange(&table->used, &used, used + (uint32_t) length + 1,
+                                                           C_RESULT_RELAXED));
+                offset = used;
+                memcpy(base + offset, text, length + 1);
+            }
+            if (c_result_atomic_compare_exchange(&slots[index], &entry, (uint64_t) hash << 32 | offset,
+                                                 C_RESULT_ACQ_REL)) {
+                c_result_atomic_fetch_add(&table->count, 1, C_RESULT_RELAXED);
+                return base + offset;
+            }
+            // Another insertion took the slot: compare against it, acquiring its text
+            entry = c_result_atomic_load(&slots[index], C_RESULT_ACQUIRE);
+        }
+    }
+    return NULL;
+}
+#else
+;
+#endif
+
+// Error creation borrowing the interned copy of message from the default table (see result_intern_set_default()).
+// Falls back to make_error() when there is no default table or it is full.
+WARN_UNUSED_RESULT static inline Result make_error_interned(const ResultCode code, const char *message) {
+#ifdef C_RESULT_NO_MESSAGES
+    (void) message;
+    return c_result_error_without_message(code);
+#else
+    const char *interned = result_intern(c_result_intern_default, message);
+    return interned ? make_error_static(code, interned) : make_error(code, message);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_INTERN_H
@@ -0,0 +1,350 @@
+#ifndef C_RESULT_IO_H
+#define C_RESULT_IO_H
+
+#include "c_result.h"
+
+// File reading helpers returning Results.
+// result_read_file_mmap() maps a whole file read-only instead of copying it through a heap buffer: the pages are
+// loaded on demand by the OS and shared with its page cache. For inputs that cannot or should not be mapped (pipes,
+// sockets, files larger than the address space), a ResultReader reads fixed-size chunks into one reused buffer.
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read-only view of a mapped file, the custom payload of result_read_file_mmap()
+typedef struct {
+    const char *data; // NULL for an empty file
+    size_t size;
+} ResultFileView;
+
+// Unmaps the view and frees it, the destructor of result_read_file_mmap() results
+static inline void result_file_view_destroy(void *data) {
+    ResultFileView *view = (ResultFileView *) data;
+    if (view->data) {
+#if defined(_WIN32)
+        UnmapViewOfFile(view->data);
+#else
+        munmap((void *) view->data, view->size);
+#endif
+    }
+    C_RESULT_FREE(view);
+}
+
+// Maps the whole file at path read-only. On success the Result owns a ResultFileView (RESULT_TYPE_CUSTOM), read it
+// with access_result_custom() and unmap it with free_result(). On failure the code tells why, e.g.
+// ERR_FILE_NOT_FOUND or ERR_PERMISSION_DENIED. The file must not be truncated while it is mapped.
+WARN_UNUSED_RESULT C_RESULT_API Result result_read_file_mmap(const char *path)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!path) {
+        return make_error_static(ERR_NULL_POINTER, "Path cannot be NULL");
+    }
+    ResultFileView *view = (ResultFileView *) C_RESULT_MALLOC(sizeof(ResultFileView));
+    if (!view) {
+        return make_error_static(ERR_OUT_OF_MEMORY, "Failed to allocate file view");
+    }
+    view->data = NULL;
+    view->size = 0;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        C_RESULT_FREE(view);
+        return make_errorf(result_code_from_win32(GetLastError()), "Cannot open '%s'", path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        const DWORD error = GetLastError();
+        CloseHandle(file);
+        C_RESULT_FREE(view);
+        return make_errorf(result_code_from_win32(error), "Cannot get the size of '%s'", path);
+    }
+    if ((unsigned long long) size.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        C_RESULT_FREE(view);
+        return make_errorf(ERR_OUT_OF_RANGE, "'%s' is too large to map", path);
+    }
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        const DWORD error = GetLastError();
+        if (mapping) {
+            CloseHandle(mapping); // The view keeps the mapping alive
+        }
+        if (!data) {
+            CloseHandle(file);
+            C_RESULT_FREE(view);
+            return make_errorf(result_code_from_win32(error), "Cannot map '%s'", path);
+        }
+        view->data = (const char *) data;
+        view->size = (size_t) size.QuadPart;
+    }
+    CloseHandle(file);
+#else
+#ifdef O_CLOEXEC
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+#else
+    const int fd = open(path, O_RDONLY);
+#endif
+    if (fd < 0) {
+        const int error = errno;
+        C_RESULT_FREE(view);
+        return make_errorf(result_code_from_errno(error), "Cannot open '%s'", path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        const int error = errno;
+        close(fd);
+        C_RESULT_FREE(view);
+        return make_errorf(result_code_from_errno(error), "Cannot stat '%s'", path);
+    }
+    if (!S_ISREG(status.st_mode)) {
+        close(fd);
+        C_RESULT_FREE(view);
+        return make_errorf(S_ISDIR(status.st_mode) ? ERR_INVALID_PATH : ERR_INVALID_OPERATION,
+                           "'%s' is not a regular file", path);
+    }
+    if ((unsigned long long) status.st_size > SIZE_MAX) {
+        close(fd);
+        C_RESULT_FREE(view);
+        return make_errorf(ERR_OUT_OF_RANGE, "'%s' is too large to map", path);
+    }
+    if (status.st_size > 0) {
+        void *data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            close(fd);
+            C_RESULT_FREE(view);
+            return make_errorf(result_code_from_errno(error), "Cannot map '%s'", path);
+        }
+        view->data = (const char *) data;
+        view->size = (size_t) status.st_size;
+    }
+    close(fd); // The mapping stays valid
+#endif
+    return make_success_custom(view, result_file_view_destroy, true);
+}
+#else
+;
+#endif
+
+// Default chunk size of a ResultReader
+#ifndef C_RESULT_READER_CHUNK_SIZE
+#define C_RESULT_READER_CHUNK_SIZE 65536
+#endif
+
+// One chunk of a ResultReader, the borrowed payload of result_reader_next()
+typedef struct {
+    const char *data;
+    size_t size;
+} ResultChunk;
+
+typedef struct {
+    ResultChunk chunk; // Last chunk read, points into buffer
+    char *buffer;
+    size_t capacity;
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    int fd;
+#endif
+    bool owns_handle; // Closed by result_reader_close()
+    bool end;
+    unsigned long error; // errno or Win32 code of a read that failed after part of a chunk, reported next
+} ResultReader;
+
+static inline ResultCode c_result_reader_init(ResultReader *reader, size_t chunk_size) {
+    chunk_size = chunk_size ? chunk_size : C_RESULT_READER_CHUNK_SIZE;
+    reader->buffer = (char *) C_RESULT_MALLOC(chunk_size);
+    if (!reader->buffer) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    reader->capacity = chunk_size;
+    reader->chunk.data = reader->buffer;
+    reader->chunk.size = 0;
+    reader->end = false;
+    reader->error = 0;
+    return SUCCESS;
+}
+
+// Opens path for reading in chunks of chunk_size bytes (0 uses C_RESULT_READER_CHUNK_SIZE).
+// Returns SUCCESS, or the code of the failure, e.g. ERR_FILE_NOT_FOUND or ERR_PERMISSION_DENIED.
+C_RESULT_API ResultCode result_reader_open(ResultReader *reader, const char *path, const size_t chunk_size)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!reader || !path) {
+        return ERR_NULL_POINTER;
+    }
+    const ResultCode code = c_result_reader_init(reader, chunk_size);
+    if (code != SUCCESS) {
+        return code;
+    }
+#if defined(_WIN32)
+    reader->handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                 FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (reader->handle == INVALID_HANDLE_VALUE) {
+        const DWORD error = GetLastError();
+        C_RESULT_FREE(reader->buffer);
+        reader->buffer = NULL;
+        return result_code_from_win32(error);
+    }
+#else
+#ifdef O_CLOEXEC
+    reader->fd = open(path, O_RDONLY | O_CLOEXEC);
+#else
+    reader->fd = open(path, O_RDONLY);
+#endif
+    if (reader->fd < 0) {
+        const int error = errno;
+        C_RESULT_FREE(reader->buffer);
+        reader->buffer = NULL;
+        return result_code_from_errno(error);
+    }
+#endif
+    reader->owns_handle = true;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Reads an already open file descriptor in chunks of chunk_size bytes (0 uses C_RESULT_READER_CHUNK_SIZE).
+// The descriptor is borrowed: result_reader_close() does not close it.
+C_RESULT_API ResultCode result_reader_from_fd(ResultReader *reader, const int fd, const size_t chunk_size)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!reader) {
+        return ERR_NULL_POINTER;
+    }
+#if defined(_WIN32)
+    const HANDLE handle = (HANDLE) _get_osfhandle(fd);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return ERR_INVALID_INPUT;
+    }
+#else
+    if (fd < 0) {
+        return ERR_INVALID_INPUT;
+    }
+#endif
+    const ResultCode code = c_result_reader_init(reader, chunk_size);
+    if (code != SUCCESS) {
+        return code;
+    }
+#if defined(_WIN32)
+    reader->handle = handle;
+#else
+    reader->fd = fd;
+#endif
+    reader->owns_handle = false;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Reads the next chunk. On success the Result holds a borrowed pointer (RESULT_TYPE_POINTER, owns_memory=false) to
+// a ResultChunk of up to chunk_size bytes; every chunk but the last is full. The chunk is only valid until the next
+// call, it reuses the reader's buffer. After the last chunk the Result is an ERR_END_OF_STREAM error.
+// When a read fails after part of a chunk was read, that partial chunk is returned first and the error, e.g.
+// ERR_RESOURCE_BUSY for EAGAIN on a non-blocking descriptor, by the next call. Later calls read again.
+WARN_UNUSED_RESULT C_RESULT_API Result result_reader_next(ResultReader *reader)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!reader || !reader->buffer) {
+        return make_error_static(ERR_NULL_POINTER, "Reader is not open");
+    }
+    if (reader->error) {
+        const unsigned long error = reader->error;
+        reader->error = 0;
+#if defined(_WIN32)
+        return make_error_from_win32(error);
+#else
+        return make_error_from_errno((int) error);
+#endif
+    }
+    size_t size = 0;
+    while (!reader->end && size < reader->capacity) {
+#if defined(_WIN32)
+        const size_t wanted = reader->capacity - size;
+        DWORD read = 0;
+        if (!ReadFile(reader->handle, reader->buffer + size, wanted > 0x40000000 ? 0x40000000 : (DWORD) wanted, &read,
+                      NULL)) {
+            const DWORD error = GetLastError();
+            if (error == ERROR_BROKEN_PIPE || error == ERROR_HANDLE_EOF) {
+                reader->end = true; // Write end of a pipe closed
+                break;
+            }
+            if (size > 0) {
+                reader->error = error;
+                break;
+            }
+            return make_error_from_win32(error);
+        }
+#else
+        const ssize_t read_size = read(reader->fd, reader->buffer + size, reader->capacity - size);
+        if (read_size < 0) {
+            const int error = errno;
+            if (error == EINTR) {
+                continue;
+            }
+            if (size > 0) {
+                reader->error = (unsigned long) error;
+                break;
+            }
+            return make_error_from_errno(error);
+        }
+        const size_t read = (size_t) read_size;
+#endif
+        if (read == 0) {
+            reader->end = true;
+        }
+        size += read;
+    }
+    if (size == 0) {
+        return make_error_static(ERR_END_OF_STREAM, "End of stream");
+    }
+    reader->chunk.data = reader->buffer;
+    reader->chunk.size = size;
+    return make_success_ptr(&reader->chunk, false);
+}
+#else
+;
+#endif
+
+// Frees the buffer and closes the file opened by result_reader_open()
+C_RESULT_API void result_reader_close(ResultReader *reader)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!reader || !reader->buffer) {
+        return;
+    }
+    if (reader->owns_handle) {
+#if defined(_WIN32)
+        CloseHandle(reader->handle);
+#else
+        close(reader->fd);
+#endif
+    }
+    C_RESULT_FREE(reader->buffer);
+    reader->buffer = NULL;
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_IO_H
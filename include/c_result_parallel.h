@@ -0,0 +1,455 @@
+#ifndef C_RESULT_PARALLEL_H
+#define C_RESULT_PARALLEL_H
+
+#include "c_result_batch.h"
+
+// Parallel map: applies a function to every index of [0, count) on several threads and stores the results straight
+// into preallocated slots of a ResultBatch, in index order. Each worker owns a contiguous range of indices, takes
+// small chunks from its front and, once it runs dry, steals the back half of another worker's range.
+// The calling thread is one worker, the others come from a process-wide pool of threads started by the first call
+// that needs them and parked on a condition variable between calls, so a call costs one wake-up per worker instead
+// of a thread creation. One call at a time runs on the pool: a concurrent or nested call (e.g. from fn) runs on its
+// calling thread alone. No memory is allocated per call or per item (except heap copies of inline error messages,
+// see result_batch_push()).
+//
+// On POSIX systems this header needs pthreads: link with -pthread.
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Stop running the function once an item returned an error. Items not run yet get an ERR_INTERRUPTED error.
+#define RESULT_PARALLEL_CANCEL_ON_ERROR 0x1
+
+// Maximum number of threads of one call
+#ifndef C_RESULT_PARALLEL_MAX_THREADS
+#define C_RESULT_PARALLEL_MAX_THREADS 64
+#endif
+
+// Mapped function: produces the Result of one index, e.g. by validating ((Record *) context)[index]
+typedef Result (*ResultParallelFn)(void *context, size_t index);
+
+typedef struct ResultParallelJob ResultParallelJob;
+
+typedef struct {
+    C_RESULT_ATOMIC(uint64_t) range; // Remaining indices: begin in the low 32 bits, end in the high 32 bits
+    ResultParallelJob *job;
+    size_t owned; // Stored entries owning memory
+    char padding[64 - sizeof(uint64_t) - sizeof(void *) - sizeof(size_t)];
+} ResultParallelWorker;
+
+struct ResultParallelJob {
+    ResultBatch *batch;
+    size_t slot; // Batch slot of index base
+    size_t base; // First index of this window, the ranges are relative to it
+    ResultParallelFn fn;
+    void *context;
+    uint32_t chunk; // Indices taken from the own range at a time
+    unsigned workers;
+    unsigned flags;
+    C_RESULT_ATOMIC(uint32_t) cancelled;
+    ResultParallelWorker worker[C_RESULT_PARALLEL_MAX_THREADS];
+};
+
+static inline uint64_t c_result_parallel_range(const uint32_t begin, const uint32_t end) {
+    return (uint64_t) begin | (uint64_t) end << 32;
+}
+
+// Number of online processors, 1 when unknown
+static inline unsigned c_result_parallel_processors(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? (unsigned) info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (unsigned) processors : 1;
+#else
+    return 1;
+#endif
+}
+
+static inline void c_result_parallel_run(ResultParallelJob *job, ResultParallelWorker *worker, const uint32_t begin,
+                                         const uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        Result result;
+        if (c_result_atomic_load(&job->cancelled, C_RESULT_RELAXED)) {
+            result = make_error_static(ERR_INTERRUPTED, "Cancelled after an earlier error");
+        } else {
+            result = job->fn(job->context, job->base + i);
+            if (!is_result_success(result) && (job->flags & RESULT_PARALLEL_CANCEL_ON_ERROR)) {
+                c_result_atomic_store(&job->cancelled, 1, C_RESULT_RELAXED);
+            }
+        }
+        const size_t slot = job->slot + i;
+        if (c_result_batch_store(job->batch, slot, result) != SUCCESS) {
+            (void) c_result_batch_store(job->batch, slot,
+                                        make_error_static(ERR_OUT_OF_MEMORY, "Failed to store the result"));
+        }
+        worker->owned += c_result_batch_owned(job->batch, slot);
+    }
+}
+
+// Steals the back half of another worker's range into the own range, returns false when every range is empty
+static inline bool c_result_parallel_steal(ResultParallelJob *job, ResultParallelWorker *worker) {
+    const unsigned self = (unsigned) (worker - job->worker);
+    for (unsigned k = 1; k < job->workers; k++) {
+        ResultParallelWorker *victim = &job->worker[(self + k) % job->workers];
+        uint64_t range = c_result_atomic_load(&victim->range, C_RESULT_ACQUIRE);
+        for (;;) {
+            const uint32_t begin = (uint32_t) range, end = (uint32_t) (range >> 32);
+            if (begin >= end) {
+                break;
+            }
+            const uint32_t middle = end - (end - begin + 1) / 2;
+            if (c_result_atomic_compare_exchange(&victim->range, &range, c_result_parallel_range(begin, middle),
+                                                 C_RESULT_ACQ_REL)) {
+                c_result_atomic_store(&worker->range, c_result_parallel_range(middle, end), C_RESULT_RELEASE);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static inline void c_result_parallel_work(ResultParallelWorker *worker) {
+    ResultParallelJob *job = worker->job;
+    do {
+        uint64_t range = c_result_atomic_load(&worker->range, C_RESULT_ACQUIRE);
+        for (;;) {
+            const uint32_t begin = (uint32_t) range, end = (uint32_t) (range >> 32);
+            if (begin >= end) {
+                break;
+            }
+            const uint32_t next = end - begin > job->chunk ? begin + job->chunk : end;
+            if (c_result_atomic_compare_exchange(&worker->range, &range, c_result_parallel_range(next, end),
+                                                 C_RESULT_ACQ_REL)) {
+                c_result_parallel_run(job, worker, begin, next);
+                range = c_result_atomic_load(&worker->range, C_RESULT_ACQUIRE);
+            }
+        }
+    } while (c_result_parallel_steal(job, worker));
+}
+
+// Pool of the workers other than the calling thread. Worker i of a job runs on pool thread i, from 1 on. The pool
+// starts zeroed: the thread holding busy initializes the synchronization objects before starting the first thread.
+typedef struct {
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    uint64_t generation; // Last job generation seen when the thread was started
+} ResultParallelThread;
+
+typedef struct {
+    C_RESULT_ATOMIC(uint32_t) busy; // Held by the call running on the pool
+    bool initialized;
+    bool stop; // Guarded by lock, tells the threads to exit
+    unsigned threads; // Threads started, numbered 1 .. threads
+    unsigned pending; // Guarded by lock, pool threads still working on job
+    unsigned workers; // Guarded by lock, workers of job, 0 once it is done
+    uint64_t generation; // Guarded by lock, bumped for every job
+    ResultParallelJob *job; // Guarded by lock
+#if defined(_WIN32)
+    SRWLOCK lock;
+    CONDITION_VARIABLE wake; // Signals a new job or stop to the threads
+    CONDITION_VARIABLE done; // Signals pending reaching 0 to the calling thread
+#else
+    pid_t process; // Process that started the threads, a forked child has none of them
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+#endif
+    ResultParallelThread thread[C_RESULT_PARALLEL_MAX_THREADS];
+} ResultParallelPool;
+
+C_RESULT_GLOBAL ResultParallelPool c_result_parallel_pool C_RESULT_ZERO;
+
+#if defined(_WIN32)
+#define C_RESULT_PARALLEL_LOCK(pool) AcquireSRWLockExclusive(&(pool)->lock)
+#define C_RESULT_PARALLEL_UNLOCK(pool) ReleaseSRWLockExclusive(&(pool)->lock)
+#define C_RESULT_PARALLEL_WAIT(pool, condition) \
+    SleepConditionVariableSRW(&(pool)->condition, &(pool)->lock, INFINITE, 0)
+#define C_RESULT_PARALLEL_WAKE_ALL(pool, condition) WakeAllConditionVariable(&(pool)->condition)
+#define C_RESULT_PARALLEL_WAKE(pool, condition) WakeConditionVariable(&(pool)->condition)
+#else
+#define C_RESULT_PARALLEL_LOCK(pool) pthread_mutex_lock(&(pool)->lock)
+#define C_RESULT_PARALLEL_UNLOCK(pool) pthread_mutex_unlock(&(pool)->lock)
+#define C_RESULT_PARALLEL_WAIT(pool, condition) pthread_cond_wait(&(pool)->condition, &(pool)->lock)
+#define C_RESULT_PARALLEL_WAKE_ALL(pool, condition) pthread_cond_broadcast(&(pool)->condition)
+#define C_RESULT_PARALLEL_WAKE(pool, condition) pthread_cond_signal(&(pool)->condition)
+#endif
+
+// Body of pool thread index: runs its worker of every job that has one, until the pool stops
+static inline void c_result_parallel_serve(const unsigned index) {
+    ResultParallelPool *pool = &c_result_parallel_pool;
+    uint64_t seen = pool->thread[index].generation;
+    C_RESULT_PARALLEL_LOCK(pool);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            C_RESULT_PARALLEL_WAIT(pool, wake);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        if (index >= pool->workers) {
+            continue; // Not needed by this job, or woken after it was done
+        }
+        ResultParallelJob *job = pool->job;
+        C_RESULT_PARALLEL_UNLOCK(pool);
+        c_result_parallel_work(&job->worker[index]);
+        C_RESULT_PARALLEL_LOCK(pool);
+        if (--pool->pending == 0) {
+            C_RESULT_PARALLEL_WAKE(pool, done);
+        }
+    }
+    C_RESULT_PARALLEL_UNLOCK(pool);
+}
+
+#if defined(_WIN32)
+static inline DWORD WINAPI c_result_parallel_thread(LPVOID index) {
+    c_result_parallel_serve((unsigned) (uintptr_t) index);
+    return 0;
+}
+#else
+static inline void *c_result_parallel_thread(void *index) {
+    c_result_parallel_serve((unsigned) (uintptr_t) index);
+    return NULL;
+}
+#endif
+
+// Takes the pool for one call and starts threads until it has *helpers of them, then sets *helpers to the number
+// of pool threads the call may use, fewer when some failed to start. Returns false when another call holds the pool.
+C_RESULT_API bool c_result_parallel_pool_acquire(unsigned *helpers)
+#ifdef C_RESULT_DEFINITIONS
+{
+    ResultParallelPool *pool = &c_result_parallel_pool;
+    uint32_t expected = 0;
+    if (!c_result_atomic_compare_exchange(&pool->busy, &expected, 1, C_RESULT_ACQUIRE)) {
+        return false;
+    }
+#if !defined(_WIN32)
+    if (pool->initialized && pool->process != getpid()) {
+        pool->initialized = false; // Forked: the threads stayed in the parent, the objects may be in any state
+    }
+#endif
+    if (!pool->initialized) {
+#if defined(_WIN32)
+        InitializeSRWLock(&pool->lock);
+        InitializeConditionVariable(&pool->wake);
+        InitializeConditionVariable(&pool->done);
+#else
+        if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+            *helpers = 0;
+            return true;
+        }
+        if (pthread_cond_init(&pool->wake, NULL) != 0) {
+            pthread_mutex_destroy(&pool->lock);
+            *helpers = 0;
+            return true;
+        }
+        if (pthread_cond_init(&pool->done, NULL) != 0) {
+            pthread_cond_destroy(&pool->wake);
+            pthread_mutex_destroy(&pool->lock);
+            *helpers = 0;
+            return true;
+        }
+        pool->process = getpid();
+#endif
+        pool->initialized = true;
+        pool->stop = false;
+        pool->threads = 0;
+        pool->pending = 0;
+        pool->workers = 0;
+        pool->generation = 0;
+        pool->job = NULL;
+    }
+    while (pool->threads < *helpers) {
+        // No job is running, the generation is stable until the caller publishes one
+        const unsigned index = pool->threads + 1;
+        pool->thread[index].generation = pool->generation;
+#if defined(_WIN32)
+        pool->thread[index].handle = CreateThread(NULL, 0, c_result_parallel_thread, (LPVOID) (uintptr_t) index, 0,
+                                                  NULL);
+        if (!pool->thread[index].handle) {
+            break;
+        }
+#else
+        if (pthread_create(&pool->thread[index].handle, NULL, c_result_parallel_thread, (void *) (uintptr_t) index)
+            != 0) {
+            break;
+        }
+#endif
+        pool->threads = index;
+    }
+    *helpers = pool->threads < *helpers ? pool->threads : *helpers;
+    return true;
+}
+#else
+;
+#endif
+
+static inline void c_result_parallel_pool_release(void) {
+    c_result_atomic_store(&c_result_parallel_pool.busy, 0, C_RESULT_RELEASE);
+}
+
+// Stops and joins the pool threads, e.g. before unloading a shared library or checking for leaks. A later
+// result_parallel_map() starts new ones. Returns ERR_RESOURCE_BUSY while a map runs on the pool.
+C_RESULT_API ResultCode c_result_parallel_pool_shutdown(void)
+#ifdef C_RESULT_DEFINITIONS
+{
+    ResultParallelPool *pool = &c_result_parallel_pool;
+    uint32_t expected = 0;
+    if (!c_result_atomic_compare_exchange(&pool->busy, &expected, 1, C_RESULT_ACQUIRE)) {
+        return ERR_RESOURCE_BUSY;
+    }
+#if !defined(_WIN32)
+    if (pool->initialized && pool->process != getpid()) {
+        pool->initialized = false; // Forked: no thread to join here
+    }
+#endif
+    if (pool->initialized) {
+        C_RESULT_PARALLEL_LOCK(pool);
+        pool->stop = true;
+        C_RESULT_PARALLEL_WAKE_ALL(pool, wake);
+        C_RESULT_PARALLEL_UNLOCK(pool);
+        for (unsigned i = 1; i <= pool->threads; i++) {
+#if defined(_WIN32)
+            WaitForSingleObject(pool->thread[i].handle, INFINITE);
+            CloseHandle(pool->thread[i].handle);
+#else
+            pthread_join(pool->thread[i].handle, NULL);
+#endif
+        }
+#if !defined(_WIN32)
+        pthread_cond_destroy(&pool->done);
+        pthread_cond_destroy(&pool->wake);
+        pthread_mutex_destroy(&pool->lock);
+#endif
+        pool->initialized = false;
+        pool->threads = 0;
+    }
+    c_result_parallel_pool_release();
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Runs one window of at most UINT32_MAX indices, on the calling thread and job->workers - 1 acquired pool threads
+static inline void c_result_parallel_window(ResultParallelJob *job, const uint32_t count) {
+    for (unsigned i = 0; i < job->workers; i++) {
+        const uint32_t begin = (uint32_t) ((uint64_t) count * i / job->workers);
+        const uint32_t end = (uint32_t) ((uint64_t) count * (i + 1) / job->workers);
+        c_result_atomic_init(&job->worker[i].range, c_result_parallel_range(begin, end));
+        job->worker[i].job = job;
+        job->worker[i].owned = 0;
+    }
+
+    if (job->workers > 1) {
+        ResultParallelPool *pool = &c_result_parallel_pool;
+        C_RESULT_PARALLEL_LOCK(pool);
+        pool->job = job;
+        pool->workers = job->workers;
+        pool->pending = job->workers - 1;
+        pool->generation++;
+        C_RESULT_PARALLEL_WAKE_ALL(pool, wake);
+        C_RESULT_PARALLEL_UNLOCK(pool);
+        c_result_parallel_work(&job->worker[0]);
+        C_RESULT_PARALLEL_LOCK(pool);
+        while (pool->pending) {
+            C_RESULT_PARALLEL_WAIT(pool, done);
+        }
+        pool->job = NULL;
+        pool->workers = 0;
+        C_RESULT_PARALLEL_UNLOCK(pool);
+    } else {
+        c_result_parallel_work(&job->worker[0]);
+    }
+    for (unsigned i = 0; i < job->workers; i++) {
+        job->batch->owned_count += job->worker[i].owned;
+    }
+}
+
+// Appends fn(context, 0) .. fn(context, count - 1) to batch, in index order, computed on threads threads (0 uses
+// one per processor). fn must be safe to call concurrently. Item errors are stored in the batch like any other
+// result, see result_batch_first_error().
+// Returns SUCCESS, ERR_INTERRUPTED when RESULT_PARALLEL_CANCEL_ON_ERROR stopped the map early, or
+// ERR_OUT_OF_MEMORY when the batch could not be grown to hold the results (then nothing was run).
+C_RESULT_API ResultCode result_parallel_map(ResultBatch *batch, const size_t count, const ResultParallelFn fn,
+                                            void *context, size_t threads, const unsigned flags)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!batch || !fn) {
+        return ERR_NULL_POINTER;
+    }
+    if (count > SIZE_MAX - batch->count) {
+        return ERR_OUT_OF_RANGE;
+    }
+    if (count == 0) {
+        return SUCCESS; // Nothing to run, the pool is neither started nor woken
+    }
+    if (result_batch_reserve(batch, batch->count + count) != SUCCESS) {
+        return ERR_OUT_OF_MEMORY;
+    }
+#ifndef C_RESULT_COMPACT
+    // Allocated up front, the workers must not race to allocate it on the first custom result
+    if (!batch->destructors && batch->capacity) {
+        batch->destructors = (CustomDestructor *) C_RESULT_MALLOC(batch->capacity * sizeof(*batch->destructors));
+        if (!batch->destructors) {
+            return ERR_OUT_OF_MEMORY;
+        }
+        memset(batch->destructors, 0, batch->capacity * sizeof(*batch->destructors));
+    }
+#endif
+
+    const uint32_t window_limit = UINT32_MAX;
+    ResultParallelJob job;
+    memset(&job, 0, sizeof(job));
+    job.batch = batch;
+    job.fn = fn;
+    job.context = context;
+    job.flags = flags;
+    c_result_atomic_init(&job.cancelled, 0);
+    if (!threads) {
+        threads = c_result_parallel_processors();
+    }
+    threads = threads > C_RESULT_PARALLEL_MAX_THREADS ? C_RESULT_PARALLEL_MAX_THREADS : threads;
+    threads = threads > count ? count : threads;
+    unsigned helpers = (unsigned) threads - 1;
+    const bool pooled = helpers && c_result_parallel_pool_acquire(&helpers);
+    threads = pooled ? helpers + 1 : 1;
+
+    for (size_t base = 0; base < count; base += window_limit) {
+        const uint32_t window = count - base > window_limit ? window_limit : (uint32_t) (count - base);
+        job.base = base;
+        job.slot = batch->count + base;
+        job.workers = (unsigned) (threads < window ? threads : window);
+        // Small chunks balance the load, large ones keep the range atomics off the profile
+        const uint32_t chunk = window / (job.workers * 16);
+        job.chunk = chunk < 1 ? 1 : chunk > 1024 ? 1024 : chunk;
+        c_result_parallel_window(&job, window);
+    }
+    if (pooled) {
+        c_result_parallel_pool_release();
+    }
+    batch->count += count;
+    return c_result_atomic_load(&job.cancelled, C_RESULT_RELAXED) ? ERR_INTERRUPTED : SUCCESS;
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_PARALLEL_H
@@ -0,0 +1,418 @@
+#ifndef C_RESULT_SERIALIZE_H
+#define C_RESULT_SERIALIZE_H
+
+#include "c_result.h"
+
+#include <limits.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compact binary wire format of a Result, for IPC and RPC.
+// A serialized Result is the zigzag varint of its code, a tag byte and a body:
+//  - success: the tag is the ResultValueType; integers are varints (zigzag for signed types), bool and char
+//    one byte, float and double their little-endian IEEE bits, strings the varint of length + 1 (0 for NULL)
+//    followed by the bytes and a NUL terminator, so that they can be borrowed in place when deserializing
+//  - error: the tag is a RESULT_WIRE_* message kind, followed by the message encoded like a string or by the
+//    varint of the OS error code. Errors with context (see result_wrap()) travel as their rendered chain.
+// Pointer and custom payloads only make sense within one process and are not serializable.
+
+// Error message kinds of the wire format
+#define RESULT_WIRE_NO_MESSAGE 0
+#define RESULT_WIRE_MESSAGE 1
+#define RESULT_WIRE_ERRNO 2 // See make_error_from_errno()
+#define RESULT_WIRE_WIN32 3 // See make_error_from_win32()
+
+// Maximum size of a serialized Result without its string or message bytes
+#define RESULT_WIRE_MAX_HEADER_SIZE 21 // 10 bytes of code varint (5 suffice in practice), tag, 10 bytes of body
+
+// Deserialize strings and messages in place: the Result borrows them from the input buffer (owns_memory=false),
+// which must then outlive it. Without this flag they are copied.
+#define RESULT_DESERIALIZE_BORROW 0x1
+
+static inline size_t c_result_varint_size(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static inline uint8_t *c_result_varint_put(uint8_t *at, uint64_t value) {
+    while (value >= 0x80) {
+        *at++ = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    *at++ = (uint8_t) value;
+    return at;
+}
+
+static inline bool c_result_varint_get(const uint8_t **at, const uint8_t *end, uint64_t *value) {
+    uint64_t decoded = 0;
+    for (unsigned shift = 0; shift < 64 && *at < end; shift += 7) {
+        const uint8_t byte = *(*at)++;
+        if (shift == 63 && byte > 1) {
+            return false; // The 10th byte holds the top bit only, more would overflow
+        }
+        decoded |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = decoded;
+            return true;
+        }
+    }
+    return false; // Truncated, or longer than 10 bytes
+}
+
+static inline uint64_t c_result_zigzag(const int64_t value) {
+    return ((uint64_t) value << 1) ^ (value < 0 ? UINT64_MAX : 0);
+}
+
+static inline int64_t c_result_unzigzag(const uint64_t value) {
+    return (int64_t) ((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Body encodings
+typedef enum {
+    C_RESULT_WIRE_EMPTY,
+    C_RESULT_WIRE_VARINT,
+    C_RESULT_WIRE_BYTE,
+    C_RESULT_WIRE_FIXED32,
+    C_RESULT_WIRE_FIXED64,
+    C_RESULT_WIRE_BYTES // Varint of length + 1, bytes, NUL
+} ResultWireEncoding;
+
+// Serializes result into buffer. *size is set to the serialized size, also when the buffer is too small: then
+// nothing is written and ERR_BUFFER_OVERFLOW is returned, so a call with a NULL buffer measures the result.
+// Returns SUCCESS, ERR_BUFFER_OVERFLOW, or ERR_INVALID_OPERATION for pointer and custom payloads.
+C_RESULT_API ResultCode result_serialize(const Result *result, uint8_t *buffer, const size_t capacity, size_t *size)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!result || !size) {
+        return ERR_NULL_POINTER;
+    }
+    uint8_t tag;
+    ResultWireEncoding encoding = C_RESULT_WIRE_VARINT;
+    uint64_t word = 0; // Varint or fixed-size body
+    const char *bytes = NULL; // String body
+    size_t length = 0;
+    bool chain = false; // The body is the rendered context chain, see result_format_chain()
+
+    if (is_result_success(*result)) {
+        tag = (uint8_t) result->value_type;
+        switch (result->value_type) {
+            case RESULT_TYPE_STRING:
+                encoding = C_RESULT_WIRE_BYTES;
+                bytes = RESULT_STRING_DATA(*result);
+                length = bytes ? strlen(bytes) : 0;
+                break;
+            case RESULT_TYPE_INT: word = c_result_zigzag(result->data.value.int_val); break;
+            case RESULT_TYPE_LONG: word = c_result_zigzag(result->data.value.long_val); break;
+            case RESULT_TYPE_SHORT: word = c_result_zigzag(result->data.value.short_val); break;
+            case RESULT_TYPE_INT8: word = c_result_zigzag(result->data.value.int8_val); break;
+            case RESULT_TYPE_INT16: word = c_result_zigzag(result->data.value.int16_val); break;
+            case RESULT_TYPE_INT32: word = c_result_zigzag(result->data.value.int32_val); break;
+            case RESULT_TYPE_INT64: word = c_result_zigzag(result->data.value.int64_val); break;
+            case RESULT_TYPE_UINT: word = result->data.value.uint_val; break;
+            case RESULT_TYPE_ULONG: word = result->data.value.ulong_val; break;
+            case RESULT_TYPE_SIZE_T: word = result->data.value.size_val; break;
+            case RESULT_TYPE_UINT8: word = result->data.value.uint8_val; break;
+            case RESULT_TYPE_UINT16: word = result->data.value.uint16_val; break;
+            case RESULT_TYPE_UINT32: word = result->data.value.uint32_val; break;
+            case RESULT_TYPE_UINT64: word = result->data.value.uint64_val; break;
+            case RESULT_TYPE_BOOL:
+                encoding = C_RESULT_WIRE_BYTE;
+                word = result->data.value.bool_val;
+                break;
+            case RESULT_TYPE_CHAR:
+                encoding = C_RESULT_WIRE_BYTE;
+                word = (uint8_t) result->data.value.char_val;
+                break;
+            case RESULT_TYPE_FLOAT: {
+                uint32_t bits;
+                memcpy(&bits, &result->data.value.float_val, sizeof(bits));
+                encoding = C_RESULT_WIRE_FIXED32;
+                word = bits;
+                break;
+            }
+            case RESULT_TYPE_DOUBLE:
+                encoding = C_RESULT_WIRE_FIXED64;
+                memcpy(&word, &result->data.value.double_val, sizeof(word));
+                break;
+            default:
+                return ERR_INVALID_OPERATION; // Pointers and custom payloads are process-local
+        }
+    } else if (result->message_storage == RESULT_MESSAGE_ERRNO || result->message_storage == RESULT_MESSAGE_WIN32) {
+        tag = result->message_storage == RESULT_MESSAGE_ERRNO ? RESULT_WIRE_ERRNO : RESULT_WIRE_WIN32;
+        word = result->data.os_error;
+    } else if (result->message_storage == RESULT_MESSAGE_CONTEXT) {
+        tag = RESULT_WIRE_MESSAGE;
+        encoding = C_RESULT_WIRE_BYTES;
+        chain = true;
+        length = result_format_chain(result, NULL, 0);
+    } else if (result->message_storage == RESULT_MESSAGE_NONE ||
+               (result->message_storage == RESULT_MESSAGE_LOCATION && !result->data.location->message)) {
+        tag = RESULT_WIRE_NO_MESSAGE;
+        encoding = C_RESULT_WIRE_EMPTY;
+    } else {
+        tag = RESULT_WIRE_MESSAGE;
+        encoding = C_RESULT_WIRE_BYTES;
+        bytes = result_get_error_message(result);
+        length = strlen(bytes);
+    }
+
+    const uint64_t code = c_result_zigzag(result->code);
+    size_t required = c_result_varint_size(code) + 1;
+    const size_t encoded_length = bytes || chain ? length + 1 : 0;
+    switch (encoding) {
+        case C_RESULT_WIRE_EMPTY: break;
+        case C_RESULT_WIRE_VARINT: required += c_result_varint_size(word); break;
+        case C_RESULT_WIRE_BYTE: required += 1; break;
+        case C_RESULT_WIRE_FIXED32: required += 4; break;
+        case C_RESULT_WIRE_FIXED64: required += 8; break;
+        case C_RESULT_WIRE_BYTES: required += c_result_varint_size(encoded_length) + encoded_length; break;
+    }
+    *size = required;
+    if (!buffer || required > capacity) {
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    uint8_t *at = c_result_varint_put(buffer, code);
+    *at++ = tag;
+    switch (encoding) {
+        case C_RESULT_WIRE_EMPTY:
+            break;
+        case C_RESULT_WIRE_VARINT:
+            c_result_varint_put(at, word);
+            break;
+        case C_RESULT_WIRE_BYTE:
+            *at = (uint8_t) word;
+            break;
+        case C_RESULT_WIRE_FIXED32:
+        case C_RESULT_WIRE_FIXED64:
+            for (unsigned i = 0; i < (encoding == C_RESULT_WIRE_FIXED32 ? 4u : 8u); i++) {
+                at[i] = (uint8_t) (word >> (8 * i));
+            }
+            break;
+        case C_RESULT_WIRE_BYTES:
+            at = c_result_varint_put(at, encoded_length);
+            if (chain) {
+                result_format_chain(result, (char *) at, length + 1);
+            } else if (bytes) {
+                memcpy(at, bytes, length);
+                at[length] = '\0';
+            }
+            break;
+    }
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+// Reads a string body, checking the NUL terminator
+static inline bool c_result_wire_bytes(const uint8_t **at, const uint8_t *end, const char **bytes, size_t *length) {
+    uint64_t encoded;
+    if (!c_result_varint_get(at, end, &encoded)) {
+        return false;
+    }
+    if (encoded == 0) {
+        *bytes = NULL;
+        *length = 0;
+        return true;
+    }
+    if (encoded > (uint64_t) (end - *at) || (*at)[encoded - 1] != '\0') {
+        return false;
+    }
+    *bytes = (const char *) *at;
+    *length = (size_t) encoded - 1;
+    *at += encoded;
+    return true;
+}
+
+// Deserializes one Result from the size bytes at buffer into *result, and sets *consumed (when not NULL) to the
+// number of bytes read, so that results sent back to back can be read in a loop.
+// Returns SUCCESS, ERR_BAD_FORMAT for truncated or invalid input (*result is then untouched), or
+// ERR_OUT_OF_MEMORY when copying a string value fails. Copied messages go through make_error().
+C_RESULT_API ResultCode result_deserialize(Result *result, const uint8_t *buffer, const size_t size, size_t *consumed,
+                                           const unsigned flags)
+#ifdef C_RESULT_DEFINITIONS
+{
+    if (!result || (!buffer && size)) {
+        return ERR_NULL_POINTER;
+    }
+    const uint8_t *at = buffer;
+    const uint8_t *end = buffer + size;
+    uint64_t word;
+    if (!c_result_varint_get(&at, end, &word) || at == end) {
+        return ERR_BAD_FORMAT;
+    }
+    const int64_t code = c_result_unzigzag(word);
+    if (code < INT32_MIN || code > INT32_MAX) {
+        return ERR_BAD_FORMAT;
+    }
+    const uint8_t tag = *at++;
+    const bool borrow = (flags & RESULT_DESERIALIZE_BORROW) != 0;
+    const char *bytes;
+    size_t length;
+
+    Result res = C_RESULT_INIT;
+    res.code = (ResultCode) code;
+    if (res.code != SUCCESS) {
+        switch (tag) {
+            case RESULT_WIRE_NO_MESSAGE:
+                res = c_result_error_without_message(res.code);
+                break;
+            case RESULT_WIRE_MESSAGE:
+                if (!c_result_wire_bytes(&at, end, &bytes, &length)) {
+                    return ERR_BAD_FORMAT;
+                }
+                res = borrow ? make_error_static(res.code, bytes) : make_error(res.code, bytes);
+                break;
+            case RESULT_WIRE_ERRNO:
+            case RESULT_WIRE_WIN32:
+                if (!c_result_varint_get(&at, end, &word) || word > UINT32_MAX) {
+                    return ERR_BAD_FORMAT;
+                }
+                res = c_result_make_os_error(res.code,
+                                             tag == RESULT_WIRE_ERRNO ? RESULT_MESSAGE_ERRNO : RESULT_MESSAGE_WIN32,
+                                             (unsigned long) word);
+                break;
+            default:
+                return ERR_BAD_FORMAT;
+        }
+        if (consumed) {
+            *consumed = (size_t) (at - buffer);
+        }
+        *result = res;
+        return SUCCESS;
+    }
+
+    res.value_type = (ResultValueType) tag;
+    int64_t value = 0;
+    switch (tag) {
+        case RESULT_TYPE_STRING: {
+            if (!c_result_wire_bytes(&at, end, &bytes, &length)) {
+                return ERR_BAD_FORMAT;
+            }
+            char *string = (char *) bytes;
+            if (bytes && !borrow) {
+                string = (char *) C_RESULT_MALLOC(length + 1);
+                if (!string) {
+                    return ERR_OUT_OF_MEMORY;
+                }
+                memcpy(string, bytes, length + 1);
+                res.owns_memory = true;
+                C_RESULT_STATS_PAYLOAD(length + 1);
+            }
+            res.data.value.string = string;
+            break;
+        }
+        case RESULT_TYPE_INT:
+        case RESULT_TYPE_LONG:
+        case RESULT_TYPE_SHORT:
+        case RESULT_TYPE_INT8:
+        case RESULT_TYPE_INT16:
+        case RESULT_TYPE_INT32:
+        case RESULT_TYPE_INT64:
+            if (!c_result_varint_get(&at, end, &word)) {
+                return ERR_BAD_FORMAT;
+            }
+            value = c_result_unzigzag(word);
+            switch (tag) {
+#define C_RESULT_WIRE_SIGNED_(type_tag, member, type, min, max) \
+    case type_tag: \
+        if (value < (min) || value > (max)) { \
+            return ERR_BAD_FORMAT; \
+        } \
+        res.data.value.member = (type) value; \
+        break;
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_INT, int_val, int, INT_MIN, INT_MAX)
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_LONG, long_val, long, LONG_MIN, LONG_MAX)
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_SHORT, short_val, short, SHRT_MIN, SHRT_MAX)
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_INT8, int8_val, int8_t, INT8_MIN, INT8_MAX)
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_INT16, int16_val, int16_t, INT16_MIN, INT16_MAX)
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_INT32, int32_val, int32_t, INT32_MIN, INT32_MAX)
+                C_RESULT_WIRE_SIGNED_(RESULT_TYPE_INT64, int64_val, int64_t, INT64_MIN, INT64_MAX)
+#undef C_RESULT_WIRE_SIGNED_
+            }
+            break;
+        case RESULT_TYPE_UINT:
+        case RESULT_TYPE_ULONG:
+        case RESULT_TYPE_SIZE_T:
+        case RESULT_TYPE_UINT8:
+        case RESULT_TYPE_UINT16:
+        case RESULT_TYPE_UINT32:
+        case RESULT_TYPE_UINT64:
+            if (!c_result_varint_get(&at, end, &word)) {
+                return ERR_BAD_FORMAT;
+            }
+            switch (tag) {
+#define C_RESULT_WIRE_UNSIGNED_(type_tag, member, type, max) \
+    case type_tag: \
+        if (word > (max)) { \
+            return ERR_BAD_FORMAT; \
+        } \
+        res.data.value.member = (type) word; \
+        break;
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_UINT, uint_val, unsigned int, UINT_MAX)
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_ULONG, ulong_val, unsigned long, ULONG_MAX)
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_SIZE_T, size_val, size_t, SIZE_MAX)
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_UINT8, uint8_val, uint8_t, UINT8_MAX)
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_UINT16, uint16_val, uint16_t, UINT16_MAX)
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_UINT32, uint32_val, uint32_t, UINT32_MAX)
+                C_RESULT_WIRE_UNSIGNED_(RESULT_TYPE_UINT64, uint64_val, uint64_t, UINT64_MAX)
+#undef C_RESULT_WIRE_UNSIGNED_
+            }
+            break;
+        case RESULT_TYPE_BOOL:
+        case RESULT_TYPE_CHAR:
+            if (at == end || (tag == RESULT_TYPE_BOOL && *at > 1)) {
+                return ERR_BAD_FORMAT;
+            }
+            if (tag == RESULT_TYPE_BOOL) {
+                res.data.value.bool_val = *at != 0;
+            } else {
+                res.data.value.char_val = (char) *at;
+            }
+            at++;
+            break;
+        case RESULT_TYPE_FLOAT:
+        case RESULT_TYPE_DOUBLE: {
+            const unsigned width = tag == RESULT_TYPE_FLOAT ? 4 : 8;
+            if ((size_t) (end - at) < width) {
+                return ERR_BAD_FORMAT;
+            }
+            word = 0;
+            for (unsigned i = 0; i < width; i++) {
+                word |= (uint64_t) at[i] << (8 * i);
+            }
+            at += width;
+            if (tag == RESULT_TYPE_FLOAT) {
+                const uint32_t bits = (uint32_t) word;
+                memcpy(&res.data.value.float_val, &bits, sizeof(bits));
+            } else {
+                memcpy(&res.data.value.double_val, &word, sizeof(word));
+            }
+            break;
+        }
+        default:
+            return ERR_BAD_FORMAT; // Not a serializable value type
+    }
+    C_RESULT_STATS_CREATED(res.value_type);
+    if (consumed) {
+        *consumed = (size_t) (at - buffer);
+    }
+    *result = res;
+    return SUCCESS;
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_SERIALIZE_H
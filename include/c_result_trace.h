@@ -0,0 +1,171 @@
+#ifndef C_RESULT_TRACE_H
+#define C_RESULT_TRACE_H
+
+#include "c_result.h"
+
+// Error origin tracing.
+// make_error_here() records where an error was created by pointing the Result at a static ResultLocation, so
+// tracking the origin costs no allocation and no string copy. On top of that, a 1-in-N sampler captures the
+// backtrace of every Nth make_error_here() of a thread into a lock-free ring buffer, which can be drained
+// periodically to build error profiles (e.g. flame graphs of where errors come from).
+
+// Number of return addresses captured per sample
+#ifndef C_RESULT_TRACE_DEPTH
+#define C_RESULT_TRACE_DEPTH 16
+#endif
+
+// Capacity of the sample ring buffer, a power of two. Samples are dropped while it is full.
+#ifndef C_RESULT_TRACE_CAPACITY
+#define C_RESULT_TRACE_CAPACITY 1024
+#endif
+C_RESULT_STATIC_ASSERT((C_RESULT_TRACE_CAPACITY & (C_RESULT_TRACE_CAPACITY - 1)) == 0,
+                       "C_RESULT_TRACE_CAPACITY must be a power of two");
+
+#if defined(_WIN32)
+#include <windows.h>
+#define C_RESULT_TRACE_BACKTRACE(frames, depth) ((int) CaptureStackBackTrace(1, depth, frames, NULL))
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define C_RESULT_TRACE_BACKTRACE(frames, depth) backtrace(frames, depth)
+#else
+#define C_RESULT_TRACE_BACKTRACE(frames, depth) ((void) (frames), (void) (depth), 0) // No backtrace support
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One sampled error
+typedef struct {
+    ResultCode code;
+    int depth; // Number of valid entries in frames
+    const ResultLocation *location;
+    void *frames[C_RESULT_TRACE_DEPTH];
+} ResultTraceSample;
+
+// Bounded multi-producer multi-consumer ring buffer (Vyukov). Each slot stores its sequence number minus its index,
+// so the zero-initialized global is a valid empty buffer without an initialization call.
+typedef struct {
+    C_RESULT_ATOMIC(size_t) sequence;
+    ResultTraceSample sample;
+} ResultTraceSlot;
+
+typedef struct {
+    ResultTraceSlot slots[C_RESULT_TRACE_CAPACITY];
+    C_RESULT_ATOMIC(size_t) head; // Next position to write
+    char padding[64 - sizeof(size_t)]; // Keeps producers and consumers off each other's cache line
+    C_RESULT_ATOMIC(size_t) tail; // Next position to read
+    C_RESULT_ATOMIC(size_t) dropped; // Samples lost while the buffer was full
+    C_RESULT_ATOMIC(uint32_t) period; // Sample one error in period, 0 disables sampling
+} ResultTraceBuffer;
+
+C_RESULT_GLOBAL ResultTraceBuffer c_result_trace C_RESULT_ZERO;
+C_RESULT_GLOBAL C_RESULT_THREAD_LOCAL uint32_t c_result_trace_countdown C_RESULT_ZERO;
+
+// Samples one make_error_here() in period, per thread. 0 disables sampling (the default), 1 samples every error.
+static inline void c_result_trace_set_sampling(const uint32_t period) {
+    c_result_atomic_store(&c_result_trace.period, period, C_RESULT_RELAXED);
+}
+
+// Number of samples dropped because the ring buffer was full
+static inline size_t c_result_trace_dropped(void) {
+    return c_result_atomic_load(&c_result_trace.dropped, C_RESULT_RELAXED);
+}
+
+// Captures the backtrace of an error into the ring buffer, or drops it when the buffer is full
+C_RESULT_API void c_result_trace_capture(const ResultCode code, const ResultLocation *location)
+#ifdef C_RESULT_DEFINITIONS
+{
+    size_t position = c_result_atomic_load(&c_result_trace.head, C_RESULT_RELAXED);
+    ResultTraceSlot *slot;
+    for (;;) {
+        slot = &c_result_trace.slots[position & (C_RESULT_TRACE_CAPACITY - 1)];
+        const size_t sequence = c_result_atomic_load(&slot->sequence, C_RESULT_ACQUIRE) +
+                                (position & (C_RESULT_TRACE_CAPACITY - 1));
+        if (sequence == position) {
+            if (c_result_atomic_compare_exchange(&c_result_trace.head, &position, position + 1, C_RESULT_RELAXED)) {
+                break;
+            }
+        } else if ((intptr_t) (sequence - position) < 0) {
+            c_result_atomic_fetch_add(&c_result_trace.dropped, 1, C_RESULT_RELAXED); // Full
+            return;
+        } else {
+            position = c_result_atomic_load(&c_result_trace.head, C_RESULT_RELAXED);
+        }
+    }
+    slot->sample.code = code;
+    slot->sample.location = location;
+    slot->sample.depth = C_RESULT_TRACE_BACKTRACE(slot->sample.frames, C_RESULT_TRACE_DEPTH);
+    c_result_atomic_store(&slot->sequence, position + 1 - (position & (C_RESULT_TRACE_CAPACITY - 1)),
+                          C_RESULT_RELEASE);
+}
+#else
+;
+#endif
+
+// Moves up to capacity samples from the ring buffer into samples, returns the number of samples moved
+C_RESULT_API size_t c_result_trace_drain(ResultTraceSample *samples, const size_t capacity)
+#ifdef C_RESULT_DEFINITIONS
+{
+    size_t count = 0;
+    size_t position = c_result_atomic_load(&c_result_trace.tail, C_RESULT_RELAXED);
+    while (count < capacity) {
+        ResultTraceSlot *slot = &c_result_trace.slots[position & (C_RESULT_TRACE_CAPACITY - 1)];
+        const size_t sequence = c_result_atomic_load(&slot->sequence, C_RESULT_ACQUIRE) +
+                                (position & (C_RESULT_TRACE_CAPACITY - 1));
+        if (sequence == position + 1) {
+            if (c_result_atomic_compare_exchange(&c_result_trace.tail, &position, position + 1, C_RESULT_RELAXED)) {
+                samples[count++] = slot->sample;
+                c_result_atomic_store(&slot->sequence,
+                                      position + C_RESULT_TRACE_CAPACITY - (position & (C_RESULT_TRACE_CAPACITY - 1)),
+                                      C_RESULT_RELEASE);
+                position++;
+            }
+        } else if ((intptr_t) (sequence - (position + 1)) < 0) {
+            break; // Empty
+        } else {
+            position = c_result_atomic_load(&c_result_trace.tail, C_RESULT_RELAXED);
+        }
+    }
+    return count;
+}
+#else
+;
+#endif
+
+// Error creation with origin tracking, sampled for backtraces when c_result_trace_set_sampling() is enabled
+WARN_UNUSED_RESULT static inline Result c_result_make_error_here(const ResultCode code,
+                                                                 const ResultLocation *location) {
+    const uint32_t period = c_result_atomic_load(&c_result_trace.period, C_RESULT_RELAXED);
+    if (period && ++c_result_trace_countdown >= period) {
+        c_result_trace_countdown = 0;
+        c_result_trace_capture(code, location);
+    }
+    return make_error_location(code, location);
+}
+
+// make_error_here(code, "literal"): error result pointing at a static record of the message, file, line and
+// function it was created at, see result_error_location(). The message must have static storage duration.
+// The record needs GNU statement expressions; without them make_error_here() falls back to make_error_static().
+// With C_RESULT_NO_MESSAGES the record and the sampling stay, only its message is compiled out.
+#ifdef C_RESULT_NO_MESSAGES
+#define C_RESULT_LOCATION_MESSAGE(message) NULL
+#else
+#define C_RESULT_LOCATION_MESSAGE(message) message
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define make_error_here(code, message) \
+    __extension__({ \
+        static const ResultLocation c_result_location_ = {__FILE__, __func__, __LINE__, \
+                                                          C_RESULT_LOCATION_MESSAGE(message)}; \
+        c_result_make_error_here(code, &c_result_location_); \
+    })
+#else
+#define make_error_here(code, message) make_error_static(code, message)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_RESULT_TRACE_H
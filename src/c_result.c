@@ -0,0 +1,12 @@
+// Single definition of the cold paths of c_result, for the c_result_static and c_result_shared targets.
+// Consumers of these targets compile with C_RESULT_EXTERN.
+#define C_RESULT_IMPLEMENTATION
+#include "c_result.h"
+#include "c_result_batch.h"
+#include "c_result_channel.h"
+#include "c_result_future.h"
+#include "c_result_intern.h"
+#include "c_result_io.h"
+#include "c_result_parallel.h"
+#include "c_result_serialize.h"
+#include "c_result_trace.h"
@@ -1,3 +1,4 @@
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "c_result.h"
@@ -5,31 +6,35 @@
 #define ERR_APP_INVALID_BYTES_READ (APP_RESULT_CODE_START - 0)
 Result process_file(const char* filename) {
     if (!filename || !filename[0]) {
-        return make_error(ERR_INVALID_INPUT, "Invalid filename");
+        return make_error_static(ERR_INVALID_INPUT, "Invalid filename");
     }
 
     FILE* file = fopen(filename, "r");
     if (!file) {
-        return make_error(ERR_FILE_IO, "Failed to open file");
+        return make_error_static(ERR_FILE_IO, "Failed to open file");
     }
 
     fseek(file, 0, SEEK_END);
     const long file_size = ftell(file);
+    if (file_size < 0) {
+        const int error = errno; // Before fseek() or fclose() can change it
+        fclose(file);
+        return make_error_from_errno(error);
+    }
     fseek(file, 0, SEEK_SET);
 
-    char* buffer = malloc(file_size + 1);
+    char* buffer = malloc((size_t) file_size + 1);
     if (!buffer) {
         fclose(file);
-        return make_error(ERR_OUT_OF_MEMORY, "Failed to allocate memory");
+        return make_error_static(ERR_OUT_OF_MEMORY, "Failed to allocate memory");
     }
 
-    const size_t bytes_read = fread(buffer, sizeof(char), file_size, file);
-    if (bytes_read != file_size) {
+    const size_t bytes_read = fread(buffer, sizeof(char), (size_t) file_size, file);
+    if (bytes_read != (size_t) file_size) {
         free(buffer);
         fclose(file);
-        char message[128];
-        sprintf(message, "Invalid amount of read bytes. Expected: %ld bytes, read %zu\n", file_size, bytes_read);
-        return make_error(ERR_APP_INVALID_BYTES_READ, message);
+        return make_errorf(ERR_APP_INVALID_BYTES_READ, "Invalid amount of read bytes. Expected: %ld bytes, read %zu",
+                           file_size, bytes_read);
     }
 
     buffer[bytes_read] = '\0';
@@ -0,0 +1,119 @@
+// Tests of batches: the SIMD scans of code arrays against a scalar reference, and ownership of pushed results
+#include "c_result_batch.h"
+#include "c_result_check.h"
+
+#if defined(C_RESULT_SIMD_AVX2)
+#define BATCH_KERNEL "AVX2"
+#elif defined(C_RESULT_SIMD_SSE2)
+#define BATCH_KERNEL "SSE2"
+#elif defined(C_RESULT_SIMD_NEON)
+#define BATCH_KERNEL "NEON"
+#else
+#define BATCH_KERNEL "scalar"
+#endif
+
+#define BATCH_MAX_CODES 300
+
+static uint64_t batch_random_state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t batch_random(void) {
+    batch_random_state ^= batch_random_state << 13;
+    batch_random_state ^= batch_random_state >> 7;
+    batch_random_state ^= batch_random_state << 17;
+    return (uint32_t) (batch_random_state >> 32);
+}
+
+// Mostly successes, and errors of every sign and magnitude, which the kernels must all tell apart from SUCCESS
+static ResultCode batch_random_code(const unsigned error_percent) {
+    static const ResultCode errors[] = {ERR_INVALID_INPUT, ERR_TIMEOUT, 1, -1000, INT32_MIN, INT32_MAX, 0x100, -256};
+    if (batch_random() % 100 >= error_percent) {
+        return SUCCESS;
+    }
+    return errors[batch_random() % (sizeof(errors) / sizeof(errors[0]))];
+}
+
+static void test_scans(void) {
+    static ResultCode storage[BATCH_MAX_CODES + 1];
+    uint64_t mask[(BATCH_MAX_CODES + 63) / 64 + 1];
+    static const unsigned densities[] = {0, 1, 10, 50, 100};
+    for (size_t count = 0; count <= BATCH_MAX_CODES; count++) {
+        for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++) {
+            // Every other run is misaligned by one code, the kernels use unaligned loads
+            ResultCode *codes = storage + (count + d) % 2;
+            size_t errors = 0, first = count;
+            for (size_t i = 0; i < count; i++) {
+                codes[i] = batch_random_code(densities[d]);
+                if (codes[i] != SUCCESS) {
+                    errors++;
+                    first = first == count ? i : first;
+                }
+            }
+            CHECK(result_codes_all_ok(codes, count) == (errors == 0));
+            CHECK(result_codes_count_errors(codes, count) == errors);
+            CHECK(result_codes_first_error(codes, count) == first);
+            const size_t words = (count + 63) / 64;
+            mask[words] = 0xDEADBEEFull; // Past the end: must stay untouched
+            result_codes_error_mask(codes, count, mask);
+            for (size_t i = 0; i < count; i++) {
+                CHECK(((mask[i / 64] >> (i % 64)) & 1) == (codes[i] != SUCCESS));
+            }
+            if (count % 64) {
+                CHECK(mask[words - 1] >> (count % 64) == 0); // Bits past count are clear
+            }
+            CHECK(mask[words] == 0xDEADBEEFull);
+        }
+    }
+}
+
+static void test_single_error_positions(void) {
+    ResultCode codes[64];
+    for (size_t position = 0; position < 64; position++) {
+        memset(codes, 0, sizeof(codes));
+        codes[position] = ERR_OUT_OF_RANGE;
+        CHECK(!result_codes_all_ok(codes, 64));
+        CHECK(result_codes_count_errors(codes, 64) == 1);
+        CHECK(result_codes_first_error(codes, 64) == position);
+        uint64_t mask = 0;
+        result_codes_error_mask(codes, 64, &mask);
+        CHECK(mask == (uint64_t) 1 << position);
+        CHECK(result_codes_all_ok(codes, position)); // The error lies past count
+    }
+}
+
+static void test_ownership(void) {
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    char *owned = (char *) malloc(8);
+    CHECK(owned != NULL);
+    strcpy(owned, "owned");
+    CHECK(result_batch_push_string(&batch, owned, true) == SUCCESS);
+    CHECK(result_batch_push_int(&batch, 3) == SUCCESS);
+    CHECK(result_batch_push_error(&batch, ERR_TIMEOUT, "Static message") == SUCCESS);
+    CHECK(result_batch_push(&batch, make_errorf(ERR_OUT_OF_RANGE, "Index %d", 12)) == SUCCESS); // Inline, copied
+    CHECK(result_batch_push(&batch, make_error(ERR_FILE_IO, "Heap message")) == SUCCESS);
+
+    CHECK(result_batch_count(&batch) == 5 && result_batch_count_errors(&batch) == 3);
+    CHECK(result_batch_first_error(&batch) == 2);
+    Result view = result_batch_get(&batch, 0);
+    const char *text = access_result_string(view);
+    CHECK(!result_owns_memory(&view) && text == owned);
+    free_result(&view); // A borrowed view: the batch still owns the string
+    CHECK(access_result_int(result_batch_get(&batch, 1)) == 3);
+#ifndef C_RESULT_NO_MESSAGES
+    Result message = result_batch_get(&batch, 3);
+    CHECK(strcmp(result_get_error_message(&message), "Index 12") == 0);
+    message = result_batch_get(&batch, 4);
+    CHECK(strcmp(result_get_error_message(&message), "Heap message") == 0);
+#endif
+    result_batch_clear(&batch); // Frees the string and the messages
+    CHECK(result_batch_count(&batch) == 0 && result_batch_all_ok(&batch));
+    result_batch_free_all(&batch);
+}
+
+int main(void) {
+    test_scans();
+    test_single_error_positions();
+    test_ownership();
+    printf("c_result_batch (" BATCH_KERNEL "): all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Tests of the MPSC channel: ordering, full channels, concurrent producers, and messages that must outlive the
+// sender's thread arena
+#include "c_result_channel.h"
+#include "c_result_check.h"
+
+#define PRODUCERS 4
+#define PER_PRODUCER 10000
+
+static void test_order_and_capacity(void) {
+    ResultChannel channel;
+    CHECK(result_channel_init(&channel, 3) == SUCCESS); // Rounded up to 4
+    for (int i = 0; i < 4; i++) {
+        Result value = make_success_int(i);
+        CHECK(result_channel_send(&channel, &value) == SUCCESS);
+        CHECK(value.code == ERR_INVALID_STATE); // Moved out
+    }
+    Result extra = make_success_int(4);
+    CHECK(result_channel_send(&channel, &extra) == ERR_NO_SPACE);
+    CHECK(access_result_int(extra) == 4); // Still ours
+
+    Result received[4];
+    CHECK(result_channel_drain(&channel, received, 4) == 4);
+    for (int i = 0; i < 4; i++) {
+        CHECK(access_result_int(received[i]) == i);
+    }
+    CHECK(!result_channel_receive(&channel, &received[0]));
+    CHECK(result_channel_send(&channel, &extra) == SUCCESS);
+    result_channel_destroy(&channel); // Frees what is still queued
+}
+
+// A message in the sender's arena is copied to the heap on send, so resetting the arena and overwriting it with
+// new messages does not change what the receiver reads
+static void test_arena_message_outlives_reset(void) {
+#ifndef C_RESULT_NO_MESSAGES
+    ResultChannel channel;
+    CHECK(result_channel_init(&channel, 4) == SUCCESS);
+    CHECK(c_result_thread_arena_init(256) == SUCCESS);
+
+    Result error = make_error(ERR_TIMEOUT, "Sent before the reset");
+    CHECK(error.message_storage == RESULT_MESSAGE_ARENA);
+    CHECK(result_channel_send(&channel, &error) == SUCCESS);
+    Result wrapped = make_error(ERR_FILE_IO, "Wrapped arena message");
+    CHECK(result_wrap(&wrapped, "While sending") == SUCCESS);
+    CHECK(result_channel_send(&channel, &wrapped) == SUCCESS);
+
+    c_result_thread_arena_reset();
+    Result overwrite = make_error(ERR_UNKNOWN, "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX");
+    CHECK(overwrite.message_storage == RESULT_MESSAGE_ARENA);
+
+    Result received;
+    CHECK(result_channel_receive(&channel, &received));
+    CHECK(received.message_storage == RESULT_MESSAGE_HEAP && result_owns_memory(&received));
+    CHECK(strcmp(result_get_error_message(&received), "Sent before the reset") == 0);
+    free_result(&received);
+    CHECK(result_channel_receive(&channel, &received));
+    char chain[64];
+    result_format_chain(&received, chain, sizeof(chain));
+    CHECK(strcmp(chain, "While sending: Wrapped arena message") == 0);
+    free_result(&received);
+
+    free_result(&overwrite);
+    c_result_thread_arena_destroy();
+    result_channel_destroy(&channel);
+#endif
+}
+
+typedef struct {
+    ResultChannel *channel;
+    int producer;
+} Producer;
+
+// Every message comes from the producer's own arena, which it resets after each send
+static void produce(void *argument) {
+    const Producer *producer = (const Producer *) argument;
+    CHECK(c_result_thread_arena_init(128) == SUCCESS);
+    for (int i = 0; i < PER_PRODUCER; i++) {
+        Result error = make_errorf(APP_RESULT_CODE_START - producer->producer, "Producer %d message %d of a long text",
+                                   producer->producer, i);
+        while (result_channel_send(producer->channel, &error) == ERR_NO_SPACE) {
+            check_thread_yield();
+        }
+        c_result_thread_arena_reset();
+    }
+    c_result_thread_arena_destroy();
+}
+
+static void test_concurrent_producers(void) {
+    ResultChannel channel;
+    CHECK(result_channel_init(&channel, 64) == SUCCESS);
+    Producer producers[PRODUCERS];
+    CheckThread threads[PRODUCERS];
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers[p].channel = &channel;
+        producers[p].producer = p;
+        check_thread_start(&threads[p], produce, &producers[p]);
+    }
+    int next[PRODUCERS] = {0};
+    for (int received = 0; received < PRODUCERS * PER_PRODUCER;) {
+        Result result;
+        if (!result_channel_receive(&channel, &result)) {
+            check_thread_yield();
+            continue;
+        }
+        const int p = APP_RESULT_CODE_START - result.code;
+        CHECK(p >= 0 && p < PRODUCERS);
+#ifndef C_RESULT_NO_MESSAGES
+        char expected[64];
+        snprintf(expected, sizeof(expected), "Producer %d message %d of a long text", p, next[p]);
+        CHECK(strcmp(result_get_error_message(&result), expected) == 0);
+#endif
+        next[p]++; // Each producer's results arrive in its send order
+        free_result(&result);
+        received++;
+    }
+    for (int p = 0; p < PRODUCERS; p++) {
+        check_thread_join(&threads[p]);
+        CHECK(next[p] == PER_PRODUCER);
+    }
+    result_channel_destroy(&channel);
+}
+
+int main(void) {
+    test_order_and_capacity();
+    test_arena_message_outlives_reset();
+    test_concurrent_producers();
+    printf("c_result_channel: all checks passed\n");
+    return 0;
+}
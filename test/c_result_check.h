@@ -0,0 +1,79 @@
+#ifndef C_RESULT_CHECK_H
+#define C_RESULT_CHECK_H
+
+// Assertions of the unit tests: unlike assert(), they stay on in Release builds and report the failed condition.
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            abort(); \
+        } \
+    } while (0)
+
+// Threads of the concurrency tests
+typedef void (*CheckThreadFn)(void *argument);
+
+typedef struct {
+    CheckThreadFn function;
+    void *argument;
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+} CheckThread;
+
+#if defined(_WIN32)
+static DWORD WINAPI check_thread_main(LPVOID thread) {
+    ((CheckThread *) thread)->function(((CheckThread *) thread)->argument);
+    return 0;
+}
+
+static inline void check_thread_start(CheckThread *thread, const CheckThreadFn function, void *argument) {
+    thread->function = function;
+    thread->argument = argument;
+    thread->handle = CreateThread(NULL, 0, check_thread_main, thread, 0, NULL);
+    CHECK(thread->handle != NULL);
+}
+
+static inline void check_thread_join(CheckThread *thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+// Lets the other threads run, in busy-wait loops
+static inline void check_thread_yield(void) {
+    SwitchToThread();
+}
+#else
+static void *check_thread_main(void *thread) {
+    ((CheckThread *) thread)->function(((CheckThread *) thread)->argument);
+    return NULL;
+}
+
+static inline void check_thread_start(CheckThread *thread, const CheckThreadFn function, void *argument) {
+    thread->function = function;
+    thread->argument = argument;
+    CHECK(pthread_create(&thread->handle, NULL, check_thread_main, thread) == 0);
+}
+
+static inline void check_thread_join(CheckThread *thread) {
+    CHECK(pthread_join(thread->handle, NULL) == 0);
+}
+
+static inline void check_thread_yield(void) {
+    sched_yield();
+}
+#endif
+
+#endif // C_RESULT_CHECK_H
@@ -0,0 +1,290 @@
+// Tests of c_result.h itself: C_RESULT_DECLARE, the allocator hooks, the thread arena, and the layouts selected by
+// C_RESULT_NO_MESSAGES and C_RESULT_COMPACT (this file is built with each of them).
+#include <stdlib.h>
+
+// Default allocation hooks, counting the live blocks so that every test can check it gave everything back
+static long core_live_blocks = 0;
+
+static void *core_malloc(const size_t size) {
+    void *memory = malloc(size);
+    core_live_blocks += memory != NULL;
+    return memory;
+}
+
+static void core_free(void *memory) {
+    core_live_blocks -= memory != NULL;
+    free(memory);
+}
+
+#define C_RESULT_MALLOC(size) core_malloc(size)
+#define C_RESULT_FREE(ptr) core_free(ptr)
+
+#include "c_result.h"
+#include "c_result_check.h"
+
+C_RESULT_DECLARE(ResultI32, int32_t)
+
+static int core_buffers_freed = 0;
+
+static void core_free_buffer(char *buffer) {
+    core_buffers_freed++;
+    free(buffer);
+}
+
+C_RESULT_DECLARE_WITH_DESTRUCTOR(ResultBuffer, char *, core_free_buffer)
+
+static void test_declare(void) {
+    CHECK(sizeof(ResultI32) == 8);
+    ResultI32 value = make_success_ResultI32(-5);
+    CHECK(is_ResultI32_success(value) && access_ResultI32(value) == -5 && access_ResultI32_or(value, 1) == -5);
+    ResultI32 error = make_error_ResultI32(ERR_OUT_OF_RANGE);
+    CHECK(!is_ResultI32_success(error) && error.code == ERR_OUT_OF_RANGE);
+    CHECK(access_ResultI32(error) == 0 && access_ResultI32_or(error, 7) == 7);
+    free_ResultI32(&value);
+    CHECK(value.code == ERR_INVALID_STATE);
+    free_ResultI32(NULL);
+
+    ResultBuffer buffer = make_success_ResultBuffer((char *) malloc(16));
+    free_ResultBuffer(&buffer);
+    free_ResultBuffer(&buffer); // Freed once, then a shell
+    CHECK(core_buffers_freed == 1);
+    ResultBuffer failed = make_error_ResultBuffer(ERR_OUT_OF_MEMORY);
+    free_ResultBuffer(&failed);
+    CHECK(core_buffers_freed == 1 && failed.code == ERR_INVALID_STATE);
+}
+
+// Registered allocator counting its blocks, or a bulk arena without release
+typedef struct {
+    int allocated;
+    int released;
+} CoreAllocatorStats;
+
+static void *core_allocate(void *context, const size_t size) {
+    ((CoreAllocatorStats *) context)->allocated++;
+    return malloc(size);
+}
+
+static void core_release(void *context, void *memory) {
+    ((CoreAllocatorStats *) context)->released++;
+    free(memory);
+}
+
+static char core_bulk[256];
+
+static void *core_bulk_allocate(void *context, const size_t size) {
+    size_t *used = (size_t *) context;
+    if (size > sizeof(core_bulk) - *used) {
+        return NULL;
+    }
+    *used += size;
+    return core_bulk + *used - size;
+}
+
+static void test_allocators(void) {
+    CoreAllocatorStats stats = {0, 0};
+    const ResultAllocator counting = {core_allocate, core_release, &stats};
+    Result registered = result_register_allocator(&counting);
+    CHECK(is_result_success(registered));
+    const uint8_t id = access_result_uint8(registered);
+    CHECK(id != RESULT_ALLOCATOR_DEFAULT);
+
+    Result error = make_error_with_allocator(id, ERR_INVALID_INPUT, "Message from the custom allocator");
+#ifdef C_RESULT_NO_MESSAGES
+    CHECK(stats.allocated == 0 && error.code == ERR_INVALID_INPUT);
+#else
+    CHECK(stats.allocated == 1 && result_allocator(&error) == id);
+    CHECK(strcmp(result_get_error_message(&error), "Message from the custom allocator") == 0);
+#endif
+    free_result(&error);
+    CHECK(stats.released == stats.allocated);
+
+    // Owned payloads tagged with the allocator go back to it
+    Result payload = make_success_ptr(counting.allocate(counting.context, 32), true);
+    result_set_allocator(&payload, id);
+    free_result(&payload);
+    CHECK(stats.released == stats.allocated && core_live_blocks == 0);
+
+    // A bulk arena has no release: free_result() leaves its memory alone
+    size_t used = 0;
+    const ResultAllocator bulk = {core_bulk_allocate, NULL, &used};
+    Result bulk_id = result_register_allocator(&bulk);
+    CHECK(is_result_success(bulk_id));
+    Result bulk_error = make_error_with_allocator(access_result_uint8(bulk_id), ERR_TIMEOUT, "Bulk message");
+    free_result(&bulk_error);
+    CHECK(bulk_error.code == ERR_INVALID_STATE);
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(used == sizeof("Bulk message") && strcmp(core_bulk, "Bulk message") == 0);
+#endif
+    // An exhausted allocator turns into ERR_OUT_OF_MEMORY
+    used = sizeof(core_bulk);
+    Result exhausted = make_error_with_allocator(access_result_uint8(bulk_id), ERR_TIMEOUT, "No room");
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(exhausted.code == ERR_OUT_OF_MEMORY);
+#endif
+    free_result(&exhausted);
+
+    // Every id up to C_RESULT_MAX_ALLOCATORS - 1 can be taken, then registration fails
+    uint8_t ids[C_RESULT_MAX_ALLOCATORS];
+    size_t taken = 0;
+    for (;;) {
+        Result next = result_register_allocator(&counting);
+        if (!is_result_success(next)) {
+            CHECK(next.code == ERR_NO_SPACE);
+            break;
+        }
+        ids[taken++] = access_result_uint8(next);
+    }
+    CHECK(taken == C_RESULT_MAX_ALLOCATORS - 3);
+    for (size_t i = 0; i < taken; i++) {
+        result_unregister_allocator(ids[i]);
+    }
+    result_unregister_allocator(access_result_uint8(bulk_id));
+    result_unregister_allocator(id);
+    Result null_allocator = result_register_allocator(NULL);
+    CHECK(null_allocator.code == ERR_NULL_POINTER);
+    CHECK(core_live_blocks == 0);
+}
+
+static void test_thread_arena(void) {
+    CHECK(c_result_thread_arena_init(128) == SUCCESS);
+    const long blocks = core_live_blocks; // The arena buffer
+    Result first = make_error(ERR_INVALID_INPUT, "Copied into the arena");
+    Result formatted = make_errorf(ERR_OUT_OF_RANGE, "Index %d is past the end of the %s, too long to be inline",
+                                   12, "records");
+    CHECK(core_live_blocks == blocks); // No heap copy
+#ifdef C_RESULT_NO_MESSAGES
+    CHECK(first.message_storage == RESULT_MESSAGE_NONE && c_result_thread_arena.used == 0);
+#else
+    CHECK(first.message_storage == RESULT_MESSAGE_ARENA && !result_owns_memory(&first));
+    CHECK(strcmp(result_get_error_message(&first), "Copied into the arena") == 0);
+    CHECK(formatted.message_storage == RESULT_MESSAGE_ARENA);
+    CHECK(strcmp(result_get_error_message(&formatted), "Index 12 is past the end of the records, too long to be inline") == 0);
+    CHECK((uintptr_t) result_get_error_message(&formatted) % C_RESULT_ARENA_ALIGNMENT == 0);
+#endif
+    // A second initialization would free the buffer under live messages
+    CHECK(c_result_thread_arena_init(256) == ERR_INVALID_STATE && core_live_blocks == blocks);
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(strcmp(result_get_error_message(&first), "Copied into the arena") == 0);
+#endif
+    free_result(&first); // Nothing to free, the arena owns the text
+    free_result(&formatted);
+
+    // A message that does not fit falls back to the heap
+    char long_message[200];
+    memset(long_message, 'x', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    Result spilled = make_error(ERR_INVALID_INPUT, long_message);
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(spilled.message_storage == RESULT_MESSAGE_HEAP && core_live_blocks == blocks + 1);
+#endif
+    free_result(&spilled);
+    CHECK(core_live_blocks == blocks);
+
+    c_result_thread_arena_reset();
+    CHECK(c_result_thread_arena.used == 0);
+    c_result_thread_arena_destroy();
+    CHECK(core_live_blocks == blocks - 1 && c_result_thread_arena.buffer == NULL);
+    Result heap = make_error(ERR_INVALID_INPUT, "Back on the heap");
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(heap.message_storage == RESULT_MESSAGE_HEAP);
+#endif
+    free_result(&heap);
+    CHECK(core_live_blocks == 0);
+}
+
+// With C_RESULT_NO_MESSAGES errors carry their code only, and describe it
+static void test_messages(void) {
+    Result heap = make_error(ERR_TIMEOUT, "Backend timed out");
+    Result formatted = make_errorf(ERR_TIMEOUT, "Backend %d timed out", 3);
+    Result borrowed = make_error_static(ERR_TIMEOUT, "Backend timed out");
+    Result os = make_error_from_errno(ENOENT);
+    CHECK(os.code == ERR_FILE_NOT_FOUND && result_error_errno(&os) == ENOENT);
+    CHECK(result_wrap(&heap, "Loading the configuration") == SUCCESS);
+#ifdef C_RESULT_NO_MESSAGES
+    CHECK(heap.message_storage == RESULT_MESSAGE_NONE && !result_owns_memory(&heap)); // Not even wrapped
+    CHECK(formatted.message_storage == RESULT_MESSAGE_NONE && borrowed.message_storage == RESULT_MESSAGE_NONE);
+    CHECK(strcmp(result_get_error_message(&heap), result_code_description(ERR_TIMEOUT)) == 0);
+    CHECK(strcmp(result_get_error_message(&os), result_code_description(ERR_FILE_NOT_FOUND)) == 0);
+    CHECK(core_live_blocks == 0);
+#else
+    CHECK(heap.message_storage == RESULT_MESSAGE_CONTEXT);
+    CHECK(strcmp(result_get_error_message(&heap), "Backend timed out") == 0);
+    CHECK(strcmp(result_get_error_message(&formatted), "Backend 3 timed out") == 0);
+    CHECK(result_get_error_message(&borrowed) == borrowed.data.message);
+    CHECK(strcmp(result_get_error_message(&os), "No such file or directory") == 0);
+#endif
+    free_result(&heap);
+    free_result(&formatted);
+    free_result(&borrowed);
+    free_result(&os);
+    c_result_context_pool_drain();
+    CHECK(core_live_blocks == 0);
+}
+
+static int core_destroyed = 0;
+
+static void core_destroy(void *data) {
+    core_destroyed++;
+    core_free(data);
+}
+
+// With C_RESULT_COMPACT a Result is 16 bytes: a custom payload with a destructor is boxed out of line
+static void test_custom_layout(void) {
+#ifdef C_RESULT_COMPACT
+    CHECK(sizeof(Result) == 16);
+#elif UINTPTR_MAX == UINT64_MAX
+    CHECK(sizeof(Result) == 32); // The inline message buffer fits the payload union
+#endif
+    int *payload = (int *) core_malloc(sizeof(int));
+    *payload = 41;
+    Result owned = make_success_custom(payload, core_destroy, true);
+    CHECK(is_result_success(owned) && access_result_custom(owned) == payload);
+#ifdef C_RESULT_COMPACT
+    CHECK((owned.flags & RESULT_FLAG_CUSTOM_BOXED) && core_live_blocks == 2); // Payload and box
+#else
+    CHECK(!(owned.flags & RESULT_FLAG_CUSTOM_BOXED) && core_live_blocks == 1);
+#endif
+    free_result(&owned);
+    CHECK(core_destroyed == 1 && core_live_blocks == 0);
+
+    // Taking the payload hands back the destructor and drops the box
+    payload = (int *) core_malloc(sizeof(int));
+    owned = make_success_custom(payload, core_destroy, true);
+    CustomDestructor destructor = NULL;
+    CHECK(result_take_custom(&owned, &destructor) == payload && destructor == core_destroy);
+    CHECK(core_live_blocks == 1 && !(owned.flags & RESULT_FLAG_CUSTOM_BOXED));
+    free_result(&owned); // No longer owns the payload
+    CHECK(core_destroyed == 1);
+    destructor(payload);
+    CHECK(core_destroyed == 2 && core_live_blocks == 0);
+
+    // A borrowed clone of a boxed payload leaves the box to the original
+    payload = (int *) core_malloc(sizeof(int));
+    owned = make_success_custom(payload, core_destroy, true);
+    result_transfer_ownership(&owned, false);
+    Result clone = result_clone(&owned);
+    CHECK(access_result_custom(clone) == payload && !(clone.flags & RESULT_FLAG_CUSTOM_BOXED));
+    free_result(&clone);
+    free_result(&owned);
+    CHECK(core_destroyed == 2 && core_live_blocks == 1);
+    core_free(payload);
+
+    // Borrowed payloads and payloads without a destructor stay in line
+    Result borrowed = make_success_custom(&core_destroyed, core_destroy, false);
+    CHECK(!(borrowed.flags & RESULT_FLAG_CUSTOM_BOXED) && access_result_custom(borrowed) == &core_destroyed);
+    free_result(&borrowed);
+    Result plain = make_success_custom(core_malloc(8), NULL, true);
+    CHECK(!(plain.flags & RESULT_FLAG_CUSTOM_BOXED));
+    free_result(&plain); // C_RESULT_FREE
+    CHECK(core_destroyed == 2 && core_live_blocks == 0);
+}
+
+int main(void) {
+    test_declare();
+    test_allocators();
+    test_thread_arena();
+    test_messages();
+    test_custom_layout();
+    printf("c_result_core: all checks passed\n");
+    return 0;
+}
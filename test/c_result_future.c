@@ -0,0 +1,101 @@
+// Tests of futures: completion, callbacks, and waits with and without a timeout
+#include "c_result_future.h"
+#include "c_result_check.h"
+
+typedef struct {
+    int calls;
+    int value;
+} CallbackState;
+
+static void on_complete(ResultFuture *future, void *context) {
+    CallbackState *state = (CallbackState *) context;
+    state->calls++;
+    Result result = result_future_get(future);
+    state->value = is_result_success(result) ? access_result_int(result) : result.code;
+    free_result(&result);
+}
+
+static void test_complete(void) {
+    ResultFuture future;
+    CHECK(result_future_init(&future) == SUCCESS);
+    CHECK(!result_future_poll(&future));
+    Result pending = result_future_get(&future);
+    CHECK(pending.code == ERR_INVALID_STATE);
+    Result timed_out = result_future_wait(&future, 0);
+    CHECK(timed_out.code == ERR_TIMEOUT && !result_future_poll(&future));
+
+    Result value = make_success_int(42);
+    const ResultPromise promise = result_future_promise(&future);
+    CHECK(result_promise_complete(promise, &value) == SUCCESS);
+    CHECK(result_future_poll(&future));
+    Result again = make_success_int(7);
+    CHECK(result_promise_complete(promise, &again) == ERR_INVALID_STATE); // Left untouched
+    CHECK(access_result_int(again) == 7);
+
+    Result taken = result_future_wait(&future, -1);
+    CHECK(access_result_int(taken) == 42);
+    result_future_destroy(&future);
+
+    // A Result never taken is freed with the future
+    CHECK(result_future_init(&future) == SUCCESS);
+    Result message = make_error(ERR_FILE_IO, "Disk on fire");
+    CHECK(result_promise_complete(result_future_promise(&future), &message) == SUCCESS);
+    result_future_destroy(&future);
+}
+
+static void test_callback(void) {
+    CallbackState state = {0, 0};
+    ResultFuture future;
+    CHECK(result_future_init(&future) == SUCCESS);
+    CHECK(result_future_on_complete(&future, on_complete, &state) == SUCCESS);
+    CHECK(result_future_on_complete(&future, on_complete, &state) == ERR_ALREADY_EXISTS);
+    CHECK(result_future_on_complete(&future, NULL, NULL) == ERR_NULL_POINTER);
+    CHECK(state.calls == 0);
+    Result value = make_success_int(5);
+    CHECK(result_promise_complete(result_future_promise(&future), &value) == SUCCESS);
+    CHECK(state.calls == 1 && state.value == 5);
+    result_future_destroy(&future);
+
+    // Registered after completion: runs right away
+    state.calls = 0;
+    CHECK(result_future_init(&future) == SUCCESS);
+    Result error = make_error_static(ERR_TIMEOUT, "Backend timed out");
+    CHECK(result_promise_complete(result_future_promise(&future), &error) == SUCCESS);
+    CHECK(result_future_on_complete(&future, on_complete, &state) == SUCCESS);
+    CHECK(state.calls == 1 && state.value == ERR_TIMEOUT);
+    result_future_destroy(&future);
+}
+
+static void complete_later(void *argument) {
+    for (int i = 0; i < 100; i++) {
+        check_thread_yield(); // Gives the waiter time to block
+    }
+    Result value = make_success_int(99);
+    CHECK(result_promise_complete(result_future_promise((ResultFuture *) argument), &value) == SUCCESS);
+}
+
+static void test_wait(void) {
+    ResultFuture future;
+    CHECK(result_future_init(&future) == SUCCESS);
+    Result timed_out = result_future_wait(&future, 20);
+    CHECK(timed_out.code == ERR_TIMEOUT);
+    result_future_destroy(&future);
+
+    for (int round = 0; round < 20; round++) {
+        CheckThread thread;
+        CHECK(result_future_init(&future) == SUCCESS);
+        check_thread_start(&thread, complete_later, &future);
+        Result value = result_future_wait(&future, round % 2 ? -1 : 10000);
+        CHECK(is_result_success(value) && access_result_int(value) == 99);
+        check_thread_join(&thread);
+        result_future_destroy(&future);
+    }
+}
+
+int main(void) {
+    test_complete();
+    test_callback();
+    test_wait();
+    printf("c_result_future: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Fuzz harness for result ownership and the wire format decoder: the input drives the operations of
+// c_result_ops.h, raw input slices are fed to result_deserialize(), and every payload must be gone at the end.
+// With libFuzzer (clang), configure with -DC_RESULT_BUILD_FUZZ=ON and run c_result_fuzz [corpus directory].
+// Other compilers, and AFL (afl-clang-fast -DC_RESULT_FUZZ_MAIN), get the standalone main, which runs the inputs
+// read from the files given as arguments, or from stdin.
+#include "c_result_ops.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, const size_t size) {
+    const size_t live = ops_live_payloads();
+    OpsState state;
+    OpsSource source = {data, size, 0};
+    ops_init(&state);
+    while (source.size) {
+        ops_step(&state, &source);
+    }
+    ops_destroy(&state);
+    OPS_CHECK(ops_live_payloads() == live);
+    return 0;
+}
+
+#ifdef C_RESULT_FUZZ_MAIN
+// Runs the input read from file, returns false when it cannot be read
+static bool fuzz_run_file(FILE *file) {
+    size_t size = 0, capacity = 4096;
+    uint8_t *data = (uint8_t *) malloc(capacity);
+    for (size_t read; data && (read = fread(data + size, 1, capacity - size, file)) > 0;) {
+        size += read;
+        if (size == capacity) {
+            uint8_t *grown = (uint8_t *) realloc(data, capacity * 2);
+            if (!grown) {
+                free(data);
+                data = NULL;
+                break;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+    if (!data) {
+        fprintf(stderr, "Out of memory\n");
+        return false;
+    }
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+    return true;
+}
+
+// Any bytes are a valid input, so ctest replays a few files of the tree through this main
+int main(const int argc, char **argv) {
+    if (argc < 2) {
+        return fuzz_run_file(stdin) ? 0 : 1;
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (!file) {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+            return 1;
+        }
+        const bool ran = fuzz_run_file(file);
+        fclose(file);
+        if (!ran) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
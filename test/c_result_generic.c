@@ -0,0 +1,109 @@
+// C11 test of the _Generic make_success() and result_get(): every arm picks the expected type tag, reads its value
+// back, and refuses errors and other types.
+#include "c_result.h"
+#include "c_result_check.h"
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L
+#error "c_result_generic.c tests the C11 _Generic API"
+#endif
+
+// Makes a result of value, checks its tag, reads it back into a variable of the same type and checks that an
+// error result is refused
+#define CHECK_ARM(T, value, tag) \
+    do { \
+        Result result = make_success(value); \
+        CHECK(is_result_success(result) && result.value_type == (tag)); \
+        CHECK(!result_owns_memory(&result)); \
+        T out = (T) 0; \
+        CHECK(result_get(result, &out) && out == (value)); \
+        Result error = make_error_static(ERR_INVALID_INPUT, "Not a value"); \
+        T untouched = (T) 0; \
+        CHECK(!result_get(error, &untouched) && untouched == (T) 0); \
+        free_result(&error); \
+        free_result(&result); \
+    } while (0)
+
+static void test_arithmetic_arms(void) {
+    CHECK_ARM(char, (char) 'y', RESULT_TYPE_CHAR);
+    CHECK_ARM(signed char, (signed char) -5, RESULT_TYPE_INT8);
+    CHECK_ARM(unsigned char, (unsigned char) 250, RESULT_TYPE_UINT8);
+    CHECK_ARM(short, (short) -1234, RESULT_TYPE_SHORT);
+    CHECK_ARM(unsigned short, (unsigned short) 65000, RESULT_TYPE_UINT16);
+    CHECK_ARM(int, -42, RESULT_TYPE_INT);
+    CHECK_ARM(unsigned int, 42u, RESULT_TYPE_UINT);
+    CHECK_ARM(long, -42L, RESULT_TYPE_LONG);
+    CHECK_ARM(unsigned long, 42UL, RESULT_TYPE_ULONG);
+    CHECK_ARM(long long, -42LL, RESULT_TYPE_INT64);
+    CHECK_ARM(unsigned long long, 42ULL, RESULT_TYPE_UINT64);
+    CHECK_ARM(float, 1.5f, RESULT_TYPE_FLOAT);
+    CHECK_ARM(double, 2.25, RESULT_TYPE_DOUBLE);
+    CHECK_ARM(bool, (bool) true, RESULT_TYPE_BOOL);
+}
+
+static void test_pointer_arms(void) {
+    char text[] = "mutable";
+    Result string = make_success(text);
+    CHECK(string.value_type == RESULT_TYPE_STRING && !result_owns_memory(&string));
+    char *read = NULL;
+    CHECK(result_get(string, &read) && read == text);
+    free_result(&string);
+
+    const char *literal = "literal";
+    Result borrowed = make_success(literal);
+    CHECK(borrowed.value_type == RESULT_TYPE_STRING && !result_owns_memory(&borrowed));
+    CHECK(result_get(borrowed, &read) && read == literal);
+    free_result(&borrowed);
+
+    int storage = 7;
+    void *address = &storage;
+    Result pointer = make_success(address);
+    CHECK(pointer.value_type == RESULT_TYPE_POINTER && !result_owns_memory(&pointer));
+    void *pointee = NULL;
+    CHECK(result_get(pointer, &pointee) && pointee == address);
+    CHECK(!result_get(pointer, &read)); // A pointer is not a string
+    free_result(&pointer);
+}
+
+static void test_type_mismatch(void) {
+    Result result = make_success(42);
+    long wide = 0;
+    double real = 0;
+    bool flag = false;
+    char character = 0;
+    CHECK(!result_get(result, &wide) && !result_get(result, &real));
+    CHECK(!result_get(result, &flag) && !result_get(result, &character));
+    free_result(&result);
+}
+
+// Fixed-width tags are read back through the fundamental type of the same representation, both ways
+static void test_fixed_width_aliases(void) {
+    Result i32 = make_success_int32(-7);
+    int value = 0;
+    CHECK(result_get(i32, &value) == (sizeof(int) == 4) && (sizeof(int) != 4 || value == -7));
+
+    Result u64 = make_success_uint64(UINT64_C(1) << 40);
+    unsigned long ulong_value = 0;
+    unsigned long long ullong_value = 0;
+    CHECK(result_get(u64, &ullong_value) && ullong_value == UINT64_C(1) << 40);
+    CHECK(result_get(u64, &ulong_value) == (sizeof(unsigned long) == 8));
+
+    Result i64 = make_success_int64(-9);
+    long long_value = 0;
+    CHECK(result_get(i64, &long_value) == (sizeof(long) == 8));
+
+    Result size = make_success_size_t(99);
+    CHECK(result_get(size, &ulong_value) == (sizeof(unsigned long) == sizeof(size_t)));
+    CHECK(result_get(size, &ullong_value) == (sizeof(unsigned long long) == sizeof(size_t)));
+
+    Result ul = make_success_ulong(5);
+    CHECK(result_get(ul, &ullong_value) == (sizeof(unsigned long) == 8));
+}
+
+int main(void) {
+    test_arithmetic_arms();
+    test_pointer_arms();
+    test_type_mismatch();
+    test_fixed_width_aliases();
+    printf("c_result_generic: all checks passed\n");
+    return 0;
+}
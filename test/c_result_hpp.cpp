@@ -0,0 +1,105 @@
+// Tests of the C++ wrapper: adopting C results, moves, clone(), release(), and the constexpr scalar constructors
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "c_result.hpp"
+#include "c_result_check.h"
+
+static int hpp_destroyed = 0;
+
+static void hpp_destroy(void *data) {
+    hpp_destroyed++;
+    std::free(data);
+}
+
+static c_result::Result hpp_parse(const char *text) {
+    if (!text) {
+        return c_result::Result::error_static(ERR_NULL_POINTER, "No text given");
+    }
+    return std::atoi(text);
+}
+
+// A raw result is moved in and left a shell, so freeing it as well is safe
+static void test_adopt() {
+    ::Result raw = make_success_custom(std::malloc(8), hpp_destroy, true);
+    {
+        c_result::Result owner(std::move(raw));
+        CHECK(owner.ok() && owner.value_type() == RESULT_TYPE_CUSTOM);
+        CHECK(raw.code == ERR_INVALID_STATE && !result_owns_memory(&raw));
+        free_result(&raw);
+        CHECK(hpp_destroyed == 0);
+    }
+    CHECK(hpp_destroyed == 1);
+
+    c_result::Result error(make_error(ERR_TIMEOUT, "Backend timed out after a long wait"));
+    CHECK(!error && error.code() == ERR_TIMEOUT);
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(std::strcmp(error.message(), "Backend timed out after a long wait") == 0);
+#endif
+}
+
+// Moves steal the payload, the source is left a shell and destroyed without freeing anything
+static void test_moves() {
+    c_result::Result first(make_success_custom(std::malloc(8), hpp_destroy, true));
+    c_result::Result second = std::move(first);
+    CHECK(!first && first.code() == ERR_INVALID_STATE && second.ok());
+    c_result::Result third;
+    CHECK(third.code() == ERR_INVALID_STATE);
+    third = std::move(second);
+    third = std::move(third); // Self-move keeps the payload
+    CHECK(third.ok() && second.code() == ERR_INVALID_STATE && hpp_destroyed == 1);
+    third = hpp_parse("12"); // Frees the custom payload
+    CHECK(hpp_destroyed == 2 && third.value_or(0) == 12);
+
+    c_result::Result missing = hpp_parse(nullptr);
+    CHECK(missing.code() == ERR_NULL_POINTER && missing.value_or(7) == 7);
+    ::Result raw = missing.release();
+    CHECK(missing.code() == ERR_INVALID_STATE && raw.code == ERR_NULL_POINTER);
+    free_result(&raw);
+}
+
+// clone() copies owned strings and shares shared payloads, each copy is freed once
+static void test_clone() {
+    char *text = static_cast<char *>(std::malloc(6));
+    std::memcpy(text, "hello", 6);
+    c_result::Result original = c_result::Result::string(text, true);
+    c_result::Result copy = original.clone();
+    char *copied = nullptr;
+    CHECK(copy.ok() && copy.read(copied) && copied != text && std::strcmp(copied, "hello") == 0);
+
+    c_result::Result shared(make_success_shared(std::malloc(8), hpp_destroy));
+    {
+        c_result::Result subscriber = shared.clone();
+        CHECK(subscriber.ok() && hpp_destroyed == 2);
+    }
+    CHECK(hpp_destroyed == 2); // One reference left
+    shared.reset();
+    CHECK(hpp_destroyed == 3 && shared.code() == ERR_INVALID_STATE);
+
+    // A borrowed custom payload, boxed or not, clones to a borrowed copy
+    int value = 5;
+    ::Result borrowed = make_success_custom(&value, hpp_destroy, true);
+    result_transfer_ownership(&borrowed, false);
+    c_result::Result view(std::move(borrowed));
+    c_result::Result view_copy = view.clone();
+    CHECK(view_copy.ok() && access_result_custom(*view_copy.get()) == &value);
+    free_result(&borrowed);
+}
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L && !defined(C_RESULT_STATS)
+static_assert(c_result::Result(42).ok());
+static_assert(c_result::Result(2.5).value_type() == RESULT_TYPE_DOUBLE);
+static_assert(c_result::Result().code() == ERR_INVALID_STATE);
+#endif
+static_assert(sizeof(c_result::Result) == sizeof(::Result), "The wrapper adds no state");
+
+int main() {
+    test_adopt();
+    test_moves();
+    test_clone();
+    CHECK(hpp_destroyed == 3);
+    std::printf("c_result_hpp: all checks passed\n");
+    return 0;
+}
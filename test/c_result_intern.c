@@ -0,0 +1,181 @@
+// Tests of the intern table: deduplication, a full table, concurrent interning and filling, and a forked child
+#include "c_result_intern.h"
+#include "c_result_check.h"
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#endif
+
+static void test_dedup(void) {
+    static uint64_t memory[512];
+    ResultInternTable *table = (ResultInternTable *) (void *) memory;
+    CHECK(result_intern_init(memory, sizeof(memory), 64) == SUCCESS);
+    CHECK(result_intern_count(table) == 0);
+
+    const char *first = result_intern(table, "Connection refused");
+    char copy[] = "Connection refused";
+    CHECK(first && strcmp(first, "Connection refused") == 0 && first != copy);
+    CHECK(result_intern(table, copy) == first);
+    const char *other = result_intern(table, "Connection reset");
+    CHECK(other && other != first && strcmp(other, "Connection reset") == 0);
+    CHECK(result_intern(table, "") != NULL);
+    CHECK(result_intern_count(table) == 3);
+    CHECK(result_intern(table, NULL) == NULL && result_intern(NULL, "text") == NULL);
+
+    CHECK(result_intern_init(memory, 64, 64) == ERR_NO_SPACE); // No room for the slots
+}
+
+// The table stops at three quarters of its slots, or when the text area is used up
+static void test_full(void) {
+    static uint64_t memory[64];
+    ResultInternTable *table = (ResultInternTable *) (void *) memory;
+    CHECK(result_intern_init(memory, sizeof(memory), 16) == SUCCESS);
+    char text[16];
+    size_t interned = 0;
+    for (int i = 0; i < 100; i++) {
+        snprintf(text, sizeof(text), "Error %d", i);
+        interned += result_intern(table, text) != NULL;
+    }
+    CHECK(interned == result_intern_count(table) && interned > 0 && interned <= 12);
+
+    // make_error_interned() falls back to a copied message
+    result_intern_set_default(table);
+    Result error = make_error_interned(ERR_INVALID_INPUT, "A message the full table has no room for");
+    CHECK(error.code == ERR_INVALID_INPUT);
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(error.message_storage == RESULT_MESSAGE_HEAP);
+    CHECK(strcmp(result_get_error_message(&error), "A message the full table has no room for") == 0);
+#endif
+    free_result(&error);
+    Result known = make_error_interned(ERR_INVALID_INPUT, "Error 0");
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(known.message_storage == RESULT_MESSAGE_STATIC);
+    CHECK(result_get_error_message(&known) == result_intern(table, "Error 0")); // Borrows the interned copy
+#endif
+    free_result(&known);
+    result_intern_set_default(NULL);
+}
+
+// Threads interning the same texts all get the same copies
+#define INTERN_TEXTS 200
+#define INTERN_THREADS 4
+
+typedef struct {
+    ResultInternTable *table;
+    const char *copies[INTERN_TEXTS];
+} InternWorker;
+
+static void intern_all(void *argument) {
+    InternWorker *worker = (InternWorker *) argument;
+    char text[32];
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < INTERN_TEXTS; i++) {
+            snprintf(text, sizeof(text), "Concurrent message %d", i);
+            worker->copies[i] = result_intern(worker->table, text);
+        }
+    }
+}
+
+static void test_concurrent(void) {
+    ResultInternTable *table = result_intern_create(64 * 1024, 1024);
+    CHECK(table != NULL);
+    static InternWorker workers[INTERN_THREADS];
+    CheckThread threads[INTERN_THREADS];
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        workers[i].table = table;
+        check_thread_start(&threads[i], intern_all, &workers[i]);
+    }
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        check_thread_join(&threads[i]);
+    }
+    CHECK(result_intern_count(table) == INTERN_TEXTS);
+    for (int i = 0; i < INTERN_TEXTS; i++) {
+        CHECK(workers[0].copies[i] != NULL);
+        for (int k = 1; k < INTERN_THREADS; k++) {
+            CHECK(workers[k].copies[i] == workers[0].copies[i]);
+        }
+    }
+    result_intern_destroy(table);
+}
+
+// Threads racing to fill the text area get whole, separate copies or NULL, and the area never overflows
+typedef struct {
+    ResultInternTable *table;
+    int worker;
+    const char *copies[INTERN_TEXTS];
+} InternFiller;
+
+static void intern_distinct(void *argument) {
+    InternFiller *filler = (InternFiller *) argument;
+    char text[32];
+    for (int i = 0; i < INTERN_TEXTS; i++) {
+        snprintf(text, sizeof(text), "Worker %d message %d", filler->worker, i);
+        filler->copies[i] = result_intern(filler->table, text);
+    }
+}
+
+static void test_concurrent_full(void) {
+    // Slots for every text, but text room for about a third of them
+    ResultInternTable *table = result_intern_create(40 * 1024, 4 * INTERN_TEXTS * INTERN_THREADS);
+    CHECK(table != NULL);
+    static InternFiller fillers[INTERN_THREADS];
+    CheckThread threads[INTERN_THREADS];
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        fillers[i].table = table;
+        fillers[i].worker = i;
+        check_thread_start(&threads[i], intern_distinct, &fillers[i]);
+    }
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        check_thread_join(&threads[i]);
+    }
+    CHECK(c_result_atomic_load(&table->used, C_RESULT_RELAXED) <= table->size);
+    size_t interned = 0;
+    char text[32];
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        for (int k = 0; k < INTERN_TEXTS; k++) {
+            if (fillers[i].copies[k]) {
+                snprintf(text, sizeof(text), "Worker %d message %d", i, k);
+                CHECK(strcmp(fillers[i].copies[k], text) == 0);
+                interned++;
+            }
+        }
+    }
+    CHECK(interned == result_intern_count(table) && interned > 0 && interned < INTERN_TEXTS * INTERN_THREADS);
+    result_intern_destroy(table);
+}
+
+#if !defined(_WIN32)
+// A table created before fork() is shared: texts interned by the child are seen by the parent at the same address
+static void test_fork(void) {
+    ResultInternTable *table = result_intern_create(16 * 1024, 64);
+    CHECK(table != NULL);
+    const char *before = result_intern(table, "Interned before fork");
+    fflush(NULL);
+    const pid_t child = fork();
+    CHECK(child >= 0);
+    if (child == 0) {
+        const bool ok = result_intern(table, "Interned before fork") == before &&
+                        result_intern(table, "Interned by the child") != NULL;
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    CHECK(waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(result_intern_count(table) == 2);
+    const char *by_child = result_intern(table, "Interned by the child");
+    CHECK(by_child && result_intern_count(table) == 2); // Found, not added
+    result_intern_destroy(table);
+}
+#endif
+
+int main(void) {
+    test_dedup();
+    test_full();
+    test_concurrent();
+    test_concurrent_full();
+#if !defined(_WIN32)
+    test_fork();
+#endif
+    printf("c_result_intern: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Tests of the file helpers: mapping whole files, chunked reading, and reads that fail part way through a chunk
+#include "c_result_io.h"
+#include "c_result_check.h"
+
+#define TEST_FILE "c_result_io_test.tmp"
+
+static const char content[] = "0123456789abcdefghijklmnopqrstuvwxyz"; // 36 bytes
+
+static void write_test_file(void) {
+    FILE *file = fopen(TEST_FILE, "wb");
+    CHECK(file != NULL);
+    CHECK(fwrite(content, 1, sizeof(content) - 1, file) == sizeof(content) - 1);
+    CHECK(fclose(file) == 0);
+}
+
+static void test_mmap(void) {
+    Result mapped = result_read_file_mmap(TEST_FILE);
+    CHECK(is_result_success(mapped) && mapped.value_type == RESULT_TYPE_CUSTOM && result_owns_memory(&mapped));
+    const ResultFileView *view = (const ResultFileView *) access_result_custom(mapped);
+    CHECK(view->size == sizeof(content) - 1 && memcmp(view->data, content, view->size) == 0);
+    free_result(&mapped); // Unmaps
+
+    FILE *file = fopen(TEST_FILE ".empty", "wb");
+    CHECK(file != NULL && fclose(file) == 0);
+    Result empty = result_read_file_mmap(TEST_FILE ".empty");
+    CHECK(is_result_success(empty));
+    view = (const ResultFileView *) access_result_custom(empty);
+    CHECK(view->data == NULL && view->size == 0);
+    free_result(&empty);
+    remove(TEST_FILE ".empty");
+
+    Result missing = result_read_file_mmap("c_result_io_missing.tmp");
+    CHECK(missing.code == ERR_FILE_NOT_FOUND);
+    free_result(&missing);
+    Result directory = result_read_file_mmap(".");
+    CHECK(directory.code == ERR_INVALID_PATH || directory.code == ERR_PERMISSION_DENIED); // Windows cannot open it
+    free_result(&directory);
+    Result null_path = result_read_file_mmap(NULL);
+    CHECK(null_path.code == ERR_NULL_POINTER);
+}
+
+static void test_reader_chunks(void) {
+    ResultReader reader;
+    CHECK(result_reader_open(&reader, TEST_FILE, 10) == SUCCESS);
+    size_t offset = 0;
+    Result chunk;
+    while (is_result_success(chunk = result_reader_next(&reader))) {
+        CHECK(chunk.value_type == RESULT_TYPE_POINTER && !result_owns_memory(&chunk));
+        const ResultChunk *data = (const ResultChunk *) chunk.data.value.pointer;
+        CHECK(data->size == (offset + 10 <= 36 ? 10 : 36 - offset)); // Every chunk but the last is full
+        CHECK(memcmp(data->data, content + offset, data->size) == 0);
+        offset += data->size;
+    }
+    CHECK(chunk.code == ERR_END_OF_STREAM && offset == 36);
+    free_result(&chunk);
+    result_reader_close(&reader);
+
+    CHECK(result_reader_open(&reader, "c_result_io_missing.tmp", 0) == ERR_FILE_NOT_FOUND);
+}
+
+#if !defined(_WIN32)
+// A non-blocking pipe fails with EAGAIN once drained: the bytes read before are returned, then the error
+static void test_reader_partial_chunk(void) {
+    int pipe_fds[2];
+    CHECK(pipe(pipe_fds) == 0);
+    CHECK(fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK) == 0);
+    CHECK(write(pipe_fds[1], "partial", 7) == 7);
+
+    ResultReader reader;
+    CHECK(result_reader_from_fd(&reader, pipe_fds[0], 64) == SUCCESS);
+    Result chunk = result_reader_next(&reader);
+    CHECK(is_result_success(chunk));
+    const ResultChunk *data = (const ResultChunk *) chunk.data.value.pointer;
+    CHECK(data->size == 7 && memcmp(data->data, "partial", 7) == 0);
+
+    Result error = result_reader_next(&reader);
+    CHECK(error.code == result_code_from_errno(EAGAIN) && result_error_errno(&error) == EAGAIN);
+    free_result(&error);
+
+    // The error was reported once, reading goes on
+    CHECK(write(pipe_fds[1], "more", 4) == 4);
+    CHECK(close(pipe_fds[1]) == 0);
+    chunk = result_reader_next(&reader);
+    CHECK(is_result_success(chunk));
+    data = (const ResultChunk *) chunk.data.value.pointer;
+    CHECK(data->size == 4 && memcmp(data->data, "more", 4) == 0);
+    chunk = result_reader_next(&reader);
+    CHECK(chunk.code == ERR_END_OF_STREAM);
+    free_result(&chunk);
+    result_reader_close(&reader); // Borrowed descriptor, still open
+    CHECK(close(pipe_fds[0]) == 0);
+}
+#endif
+
+int main(void) {
+    write_test_file();
+    test_mmap();
+    test_reader_chunks();
+#if !defined(_WIN32)
+    test_reader_partial_chunk();
+#endif
+    remove(TEST_FILE);
+    printf("c_result_io: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,336 @@
+#ifndef C_RESULT_OPS_H
+#define C_RESULT_OPS_H
+
+// Random ownership operations on a small set of results, shared by the fuzz harness and the stress benchmark.
+// Each step constructs a result of any ResultValueType, moves, clones, takes the payload out of, wraps,
+// serializes, batches, inspects or frees one, and checks the ownership invariants along the way: a freed or
+// moved-from result is a shell, and so stays when freed again. Double frees and leaks are left to the sanitizers,
+// payloads with a destructor are also counted, see ops_live_payloads().
+#include <stdio.h>
+#include <stdlib.h>
+#include "c_result.h"
+#include "c_result_batch.h"
+#include "c_result_serialize.h"
+#include "c_result_trace.h"
+
+#define OPS_SLOTS 8
+#define OPS_BATCH_LIMIT 32
+
+#define OPS_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            abort(); \
+        } \
+    } while (0)
+
+// Source of the choices: the fuzz input byte by byte, or a xorshift generator when data is NULL
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    uint64_t state;
+} OpsSource;
+
+static inline uint8_t ops_byte(OpsSource *source) {
+    if (source->data) {
+        if (!source->size) {
+            return 0;
+        }
+        source->size--;
+        return *source->data++;
+    }
+    source->state ^= source->state << 13;
+    source->state ^= source->state >> 7;
+    source->state ^= source->state << 17;
+    return (uint8_t) (source->state >> 32);
+}
+
+static inline uint64_t ops_word(OpsSource *source) {
+    uint64_t word = 0;
+    for (int i = 0; i < 8; i++) {
+        word = word << 8 | ops_byte(source);
+    }
+    return word;
+}
+
+// Moves a result elsewhere, e.g. into a channel to another thread. Returns false when it kept the result.
+typedef bool (*OpsExchangeFn)(void *context, Result *result);
+
+typedef struct {
+    Result slots[OPS_SLOTS];
+    ResultBatch batch;
+    OpsExchangeFn send; // Optional
+    OpsExchangeFn receive; // Optional, fills an empty result
+    void *context;
+    size_t operations;
+} OpsState;
+
+// Payloads with a destructor alive in the process
+C_RESULT_GLOBAL C_RESULT_ATOMIC(size_t) ops_live C_RESULT_ZERO;
+
+static inline size_t ops_live_payloads(void) {
+    return c_result_atomic_load(&ops_live, C_RESULT_ACQUIRE);
+}
+
+static inline void *ops_payload_new(const uint8_t fill) {
+    uint8_t *payload = (uint8_t *) malloc(16);
+    if (payload) {
+        memset(payload, fill, 16);
+        c_result_atomic_fetch_add(&ops_live, 1, C_RESULT_RELAXED);
+    }
+    return payload;
+}
+
+static inline void ops_payload_destroy(void *payload) {
+    if (!payload) {
+        return; // Allocation failed in ops_payload_new()
+    }
+    c_result_atomic_fetch_sub(&ops_live, 1, C_RESULT_RELAXED);
+    free(payload);
+}
+
+static inline char *ops_string_new(const uint8_t length) {
+    char *text = (char *) malloc((size_t) length + 1);
+    if (text) {
+        memset(text, 'a' + length % 26, length);
+        text[length] = '\0';
+    }
+    return text;
+}
+
+static uint8_t ops_static_payload[16];
+
+static inline bool ops_is_shell(const Result *result) {
+    return result->code == ERR_INVALID_STATE && !result->owns_memory && !(result->flags & RESULT_FLAG_CUSTOM_BOXED);
+}
+
+static inline Result ops_make_error(OpsSource *source) {
+    const uint8_t flavor = ops_byte(source);
+    switch (flavor % 9) {
+        case 0:
+            return make_error(ERR_FILE_NOT_FOUND, "A message long enough to be copied to the heap by make_error()");
+        case 1: return make_error(ERR_TIMEOUT, "");
+        case 2: return make_error_static(ERR_INVALID_INPUT, "Borrowed message");
+        case 3: return make_errorf(ERR_BAD_FORMAT, "e%u", flavor); // Inline
+        case 4: return make_errorf(ERR_OUT_OF_RANGE, "Formatted to the heap, flavor %u of a long message", flavor);
+        case 5: return make_error_from_errno(flavor);
+        case 6: return make_error_from_win32(flavor);
+        case 7: return make_error_here(ERR_INVALID_STATE, "Located error");
+        default: return make_error(APP_RESULT_CODE_START - flavor, NULL);
+    }
+}
+
+// A result of every ResultValueType, owning, borrowing or sharing its payload
+static inline Result ops_make(OpsSource *source) {
+    const uint8_t type = ops_byte(source) % (RESULT_TYPE_CUSTOM + 1);
+    const uint8_t flavor = ops_byte(source);
+    switch ((ResultValueType) type) {
+        case RESULT_TYPE_NONE: return ops_make_error(source);
+        case RESULT_TYPE_POINTER:
+            return flavor & 1 ? make_success_ptr(calloc(1, flavor + 1u), true)
+                              : make_success_ptr(ops_static_payload, false);
+        case RESULT_TYPE_STRING:
+            switch (flavor % 3) {
+                case 0: return make_success_string(ops_string_new(flavor), true);
+                case 1: return make_success_string((char *) "borrowed", false);
+                default: return make_success_shared_string(ops_string_new(flavor), NULL);
+            }
+        case RESULT_TYPE_INT: return make_success_int((int) ops_word(source));
+        case RESULT_TYPE_LONG: return make_success_long((long) ops_word(source));
+        case RESULT_TYPE_FLOAT: return make_success_float((float) flavor / 3.0f);
+        case RESULT_TYPE_DOUBLE: return make_success_double((double) ops_word(source) / 7.0);
+        case RESULT_TYPE_BOOL: return make_success_bool(flavor & 1);
+        case RESULT_TYPE_CHAR: return make_success_char((char) flavor);
+        case RESULT_TYPE_SHORT: return make_success_short((short) ops_word(source));
+        case RESULT_TYPE_UINT: return make_success_uint((unsigned int) ops_word(source));
+        case RESULT_TYPE_ULONG: return make_success_ulong((unsigned long) ops_word(source));
+        case RESULT_TYPE_SIZE_T: return make_success_size_t((size_t) ops_word(source));
+        case RESULT_TYPE_INT8: return make_success_int8((int8_t) flavor);
+        case RESULT_TYPE_UINT8: return make_success_uint8(flavor);
+        case RESULT_TYPE_INT16: return make_success_int16((int16_t) ops_word(source));
+        case RESULT_TYPE_UINT16: return make_success_uint16((uint16_t) ops_word(source));
+        case RESULT_TYPE_INT32: return make_success_int32((int32_t) ops_word(source));
+        case RESULT_TYPE_UINT32: return make_success_uint32((uint32_t) ops_word(source));
+        case RESULT_TYPE_INT64: return make_success_int64((int64_t) ops_word(source));
+        case RESULT_TYPE_UINT64: return make_success_uint64(ops_word(source));
+        case RESULT_TYPE_CUSTOM:
+            switch (flavor % 4) {
+                case 0: return make_success_custom(ops_payload_new(flavor), ops_payload_destroy, true);
+                case 1: return make_success_custom(calloc(1, 8), NULL, true); // Freed with C_RESULT_FREE
+                case 2: return make_success_custom(ops_static_payload, ops_payload_destroy, false);
+                default: return make_success_shared(ops_payload_new(flavor), ops_payload_destroy);
+            }
+    }
+    return make_success_int(0);
+}
+
+// Reads everything a result points to, so that the sanitizers see use after free
+static inline void ops_touch(const Result *result) {
+    volatile size_t sink = strlen(result_get_error_message(result));
+    char text[64];
+    sink += result_format_chain(result, text, sizeof(text));
+    if (is_result_success(*result)) {
+        if (result->value_type == RESULT_TYPE_STRING) {
+            const char *string = RESULT_STRING_DATA(*result);
+            sink += string ? strlen(string) : 0;
+        } else if (result->value_type == RESULT_TYPE_CUSTOM) {
+            const uint8_t *payload = (const uint8_t *) RESULT_CUSTOM_DATA(*result);
+            sink += payload ? payload[0] : 0;
+        } else if (result->value_type == RESULT_TYPE_POINTER) {
+            const uint8_t *payload = (const uint8_t *) result->data.value.pointer;
+            sink += payload ? payload[0] : 0;
+        }
+    }
+    (void) sink;
+}
+
+static inline void ops_free(Result *result) {
+    free_result(result);
+    OPS_CHECK(ops_is_shell(result));
+}
+
+// Takes the payload out of a result and frees it by hand. The result then borrows the freed payload, so it is
+// reset to a shell, as the owner of a taken payload would do.
+static inline void ops_take(Result *result) {
+    void *pointer = result_take_ptr(result);
+    char *string = result_take_string(result);
+    CustomDestructor destructor = NULL;
+    void *custom = result_take_custom(result, &destructor);
+    OPS_CHECK(!result_owns_memory(result) || !is_result_success(*result) || (result->flags & RESULT_FLAG_SHARED));
+    if (pointer || string || custom) {
+        free(pointer);
+        free(string);
+        if (destructor) {
+            destructor(custom);
+        } else {
+            free(custom);
+        }
+        c_result_make_shell(result);
+    }
+}
+
+// Serializes a result and deserializes it into target, checking that the code survives
+static inline void ops_round_trip(const Result *result, Result *target) {
+    uint8_t wire[256];
+    size_t size = 0;
+    const ResultCode code = result_serialize(result, wire, sizeof(wire), &size);
+    OPS_CHECK(code == SUCCESS || code == ERR_BUFFER_OVERFLOW || code == ERR_INVALID_OPERATION);
+    if (code != SUCCESS) {
+        return;
+    }
+    size_t consumed = 0;
+    ops_free(target);
+    OPS_CHECK(result_deserialize(target, wire, size, &consumed, 0) == SUCCESS);
+    OPS_CHECK(consumed == size && target->code == result->code);
+}
+
+// Deserializes raw input, borrowing from it, and drops the result again
+static inline void ops_decode(OpsSource *source) {
+    uint8_t wire[64];
+    const size_t size = ops_byte(source) % sizeof(wire);
+    for (size_t i = 0; i < size; i++) {
+        wire[i] = ops_byte(source);
+    }
+    const unsigned flags = size & 1 ? RESULT_DESERIALIZE_BORROW : 0;
+    Result result;
+    size_t consumed = 0;
+    const ResultCode code = result_deserialize(&result, wire, size, &consumed, flags);
+    OPS_CHECK(code == SUCCESS || code == ERR_BAD_FORMAT || code == ERR_OUT_OF_MEMORY);
+    if (code == SUCCESS) {
+        OPS_CHECK(consumed <= size);
+        ops_touch(&result);
+        ops_free(&result);
+    }
+}
+
+static inline void ops_init(OpsState *state) {
+    memset(state, 0, sizeof(*state));
+    for (size_t i = 0; i < OPS_SLOTS; i++) {
+        c_result_make_shell(&state->slots[i]);
+    }
+    OPS_CHECK(result_batch_init(&state->batch, OPS_BATCH_LIMIT) == SUCCESS);
+}
+
+static inline void ops_step(OpsState *state, OpsSource *source) {
+    const uint8_t op = ops_byte(source);
+    Result *a = &state->slots[ops_byte(source) % OPS_SLOTS];
+    Result *b = &state->slots[ops_byte(source) % OPS_SLOTS];
+    state->operations++;
+    switch (op % 14) {
+        case 0:
+        case 1:
+            ops_free(a);
+            *a = ops_make(source);
+            break;
+        case 2:
+            if (a != b) {
+                ops_free(b);
+                result_move(b, a);
+                OPS_CHECK(ops_is_shell(a));
+            }
+            break;
+        case 3:
+            if (a != b) {
+                ops_free(b);
+                *b = result_clone(a);
+            }
+            break;
+        case 4:
+            ops_take(a);
+            break;
+        case 5:
+            ops_free(a);
+            ops_free(a); // Freeing a shell again is harmless
+            break;
+        case 6:
+            OPS_CHECK(result_wrap(a, op & 0x10 ? "Context" : "") == SUCCESS);
+            break;
+        case 7:
+            OPS_CHECK(result_wrapf(a, "Context %u of a frame text that is longer than the frame can hold", op) ==
+                      SUCCESS);
+            break;
+        case 8:
+            if (a != b) {
+                ops_round_trip(a, b);
+            }
+            break;
+        case 9:
+            ops_decode(source);
+            break;
+        case 10: {
+            if (result_batch_count(&state->batch) >= OPS_BATCH_LIMIT) {
+                result_batch_clear(&state->batch);
+            }
+            Result moved;
+            result_move(&moved, a);
+            OPS_CHECK(result_batch_push(&state->batch, moved) == SUCCESS);
+            const Result view = result_batch_get(&state->batch, ops_byte(source) % result_batch_count(&state->batch));
+            ops_touch(&view);
+            break;
+        }
+        case 11:
+            if (state->send && state->send(state->context, a)) {
+                OPS_CHECK(ops_is_shell(a));
+            }
+            break;
+        case 12:
+            if (state->receive) {
+                ops_free(a);
+                state->receive(state->context, a);
+            }
+            break;
+        default:
+            ops_touch(a);
+            break;
+    }
+}
+
+static inline void ops_destroy(OpsState *state) {
+    for (size_t i = 0; i < OPS_SLOTS; i++) {
+        ops_free(&state->slots[i]);
+    }
+    result_batch_free_all(&state->batch);
+    c_result_context_pool_drain();
+}
+
+#endif // C_RESULT_OPS_H
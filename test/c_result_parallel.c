@@ -0,0 +1,163 @@
+// Tests of the parallel map: index order, cancellation, and the reuse of the pool threads across calls
+#include "c_result_parallel.h"
+#include "c_result_check.h"
+
+// ThreadSanitizer does not support starting threads in the child of a multi-threaded process
+#if defined(__SANITIZE_THREAD__)
+#define CHECK_NO_FORK
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define CHECK_NO_FORK
+#endif
+#endif
+
+#if !defined(_WIN32) && !defined(CHECK_NO_FORK)
+#include <sys/wait.h>
+#endif
+
+static Result twice(void *context, const size_t index) {
+    (void) context;
+    return make_success_int64((int64_t) index * 2);
+}
+
+static void check_twice(const ResultBatch *batch, const size_t first, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Result result = result_batch_get(batch, first + i);
+        CHECK(result.value_type == RESULT_TYPE_INT64 && result.data.value.int64_val == (int64_t) i * 2);
+    }
+}
+
+static void test_order(void) {
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    CHECK(result_parallel_map(&batch, 100000, twice, NULL, 4, 0) == SUCCESS);
+    CHECK(result_batch_count(&batch) == 100000 && result_batch_all_ok(&batch));
+    check_twice(&batch, 0, 100000);
+    // Appends after what the batch holds, also with fewer items than threads
+    CHECK(result_parallel_map(&batch, 3, twice, NULL, 8, 0) == SUCCESS);
+    CHECK(result_batch_count(&batch) == 100003);
+    check_twice(&batch, 100000, 3);
+    CHECK(result_parallel_map(&batch, 0, twice, NULL, 8, 0) == SUCCESS);
+    result_batch_free_all(&batch);
+}
+
+static Result fail_at_100(void *context, const size_t index) {
+    (void) context;
+    return index == 100 ? make_error_static(ERR_INVALID_INPUT, "Bad record") : make_success_int((int) index);
+}
+
+static void test_cancel(void) {
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    CHECK(result_parallel_map(&batch, 50000, fail_at_100, NULL, 4, RESULT_PARALLEL_CANCEL_ON_ERROR) ==
+          ERR_INTERRUPTED);
+    CHECK(result_batch_count(&batch) == 50000 && result_batch_code(&batch, 100) == ERR_INVALID_INPUT);
+    for (size_t i = 0; i < 50000; i++) {
+        const ResultCode code = result_batch_code(&batch, i);
+        CHECK(code == SUCCESS || code == ERR_INTERRUPTED || i == 100);
+    }
+    result_batch_clear(&batch);
+    CHECK(result_parallel_map(&batch, 1000, fail_at_100, NULL, 4, 0) == SUCCESS); // Errors are only stored
+    CHECK(result_batch_count_errors(&batch) == 1 && result_batch_first_error(&batch) == 100);
+    result_batch_free_all(&batch);
+}
+
+// The pool keeps its threads between calls and only grows to the largest call
+static void test_pool_reuse(void) {
+    CHECK(c_result_parallel_pool_shutdown() == SUCCESS);
+    CHECK(c_result_parallel_pool.threads == 0);
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    CHECK(result_parallel_map(&batch, 0, twice, NULL, 4, 0) == SUCCESS); // Nothing to run, no pool
+    CHECK(batch.count == 0 && c_result_parallel_pool.threads == 0 && !c_result_parallel_pool.initialized);
+    for (int call = 0; call < 200; call++) {
+        CHECK(result_parallel_map(&batch, 64, twice, NULL, call % 2 ? 2 : 4, 0) == SUCCESS);
+        CHECK(c_result_parallel_pool.threads == 3);
+        check_twice(&batch, 0, 64);
+        result_batch_clear(&batch);
+    }
+    result_batch_free_all(&batch);
+    CHECK(c_result_parallel_pool_shutdown() == SUCCESS);
+    CHECK(c_result_parallel_pool.threads == 0 && !c_result_parallel_pool.initialized);
+}
+
+// A map called from fn finds the pool held by the outer one and runs on its own thread
+static Result nested(void *context, const size_t index) {
+    (void) context;
+    ResultBatch inner;
+    if (result_batch_init(&inner, 0) != SUCCESS) {
+        return make_error_static(ERR_OUT_OF_MEMORY, "No batch");
+    }
+    const ResultCode code = result_parallel_map(&inner, index % 7, twice, NULL, 4, 0);
+    const size_t count = result_batch_count(&inner);
+    result_batch_free_all(&inner);
+    return code == SUCCESS && count == index % 7 ? make_success_int((int) index)
+                                                  : make_error_static(ERR_INVALID_STATE, "Nested map failed");
+}
+
+static void test_nested(void) {
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    CHECK(result_parallel_map(&batch, 500, nested, NULL, 4, 0) == SUCCESS);
+    CHECK(result_batch_all_ok(&batch));
+    result_batch_free_all(&batch);
+}
+
+// Concurrent calls: one gets the pool, the others run alone, all results are right
+static void concurrent_maps(void *argument) {
+    (void) argument;
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    for (int call = 0; call < 50; call++) {
+        CHECK(result_parallel_map(&batch, 1000, twice, NULL, 3, 0) == SUCCESS);
+        check_twice(&batch, 0, 1000);
+        result_batch_clear(&batch);
+    }
+    result_batch_free_all(&batch);
+}
+
+static void test_concurrent(void) {
+    CheckThread threads[3];
+    for (int i = 0; i < 3; i++) {
+        check_thread_start(&threads[i], concurrent_maps, NULL);
+    }
+    for (int i = 0; i < 3; i++) {
+        check_thread_join(&threads[i]);
+    }
+}
+
+#if !defined(_WIN32) && !defined(CHECK_NO_FORK)
+// A forked child has none of the pool threads of its parent and starts its own
+static void test_fork(void) {
+    ResultBatch batch;
+    CHECK(result_batch_init(&batch, 0) == SUCCESS);
+    CHECK(result_parallel_map(&batch, 1000, twice, NULL, 4, 0) == SUCCESS); // Parent pool running
+    result_batch_clear(&batch);
+    fflush(NULL);
+    const pid_t child = fork();
+    CHECK(child >= 0);
+    if (child == 0) {
+        const bool ok = result_parallel_map(&batch, 1000, twice, NULL, 4, 0) == SUCCESS &&
+                        result_batch_count(&batch) == 1000 && result_batch_get(&batch, 999).data.value.int64_val == 1998;
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    CHECK(waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    result_batch_free_all(&batch);
+}
+#endif
+
+int main(void) {
+    test_order();
+    test_cancel();
+    test_pool_reuse();
+    test_nested();
+    test_concurrent();
+#if !defined(_WIN32) && !defined(CHECK_NO_FORK)
+    test_fork();
+#endif
+    CHECK(c_result_parallel_pool_shutdown() == SUCCESS);
+    printf("c_result_parallel: all checks passed\n");
+    return 0;
+}
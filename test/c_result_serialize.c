@@ -0,0 +1,82 @@
+// Tests of the wire format: round trips, and rejection of malformed input
+#include "c_result_serialize.h"
+#include "c_result_check.h"
+
+static Result round_trip(const Result *result, uint8_t *wire, const size_t capacity, const unsigned flags) {
+    size_t size = 0, consumed = 0;
+    CHECK(result_serialize(result, wire, capacity, &size) == SUCCESS);
+    Result decoded;
+    CHECK(result_deserialize(&decoded, wire, size, &consumed, flags) == SUCCESS);
+    CHECK(consumed == size && decoded.code == result->code);
+    return decoded;
+}
+
+static void test_round_trips(void) {
+    uint8_t wire[128];
+    Result values[] = {make_success_int(-7), make_success_uint64(UINT64_MAX), make_success_int64(INT64_MIN),
+                       make_success_double(0.1), make_success_bool(true), make_success_char('x')};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        Result decoded = round_trip(&values[i], wire, sizeof(wire), 0);
+        CHECK(decoded.value_type == values[i].value_type);
+        CHECK(memcmp(&decoded.data.value, &values[i].data.value, sizeof(uint64_t)) == 0);
+        free_result(&decoded);
+    }
+
+    Result string = make_success_string((char *) "payload", false);
+    Result copied = round_trip(&string, wire, sizeof(wire), 0);
+    const char *text = access_result_string(copied);
+    CHECK(result_owns_memory(&copied) && text && strcmp(text, "payload") == 0);
+    free_result(&copied);
+    Result borrowed = round_trip(&string, wire, sizeof(wire), RESULT_DESERIALIZE_BORROW);
+    CHECK(!result_owns_memory(&borrowed) && (uint8_t *) access_result_string(borrowed) > wire);
+    free_result(&borrowed);
+
+    Result error = make_error(ERR_TIMEOUT, "Timed out talking to the peer");
+    Result decoded = round_trip(&error, wire, sizeof(wire), 0);
+#ifndef C_RESULT_NO_MESSAGES
+    CHECK(strcmp(result_get_error_message(&decoded), "Timed out talking to the peer") == 0);
+#endif
+    free_result(&decoded);
+    free_result(&error);
+}
+
+// A varint has at most 10 bytes, and the 10th only holds bit 63
+static void test_varint_overflow(void) {
+    uint8_t wire[RESULT_WIRE_MAX_HEADER_SIZE];
+    size_t size = 0, consumed = 0;
+    const Result max = make_success_uint64(UINT64_MAX);
+    CHECK(result_serialize(&max, wire, sizeof(wire), &size) == SUCCESS);
+    CHECK(wire[size - 1] == 0x01); // Last byte of the body varint
+
+    Result decoded;
+    CHECK(result_deserialize(&decoded, wire, size, &consumed, 0) == SUCCESS);
+    CHECK(access_result_uint64(decoded) == UINT64_MAX);
+    free_result(&decoded);
+
+    for (unsigned last = 0x02; last <= 0x7F; last++) {
+        wire[size - 1] = (uint8_t) last;
+        CHECK(result_deserialize(&decoded, wire, size, &consumed, 0) == ERR_BAD_FORMAT);
+    }
+    wire[size - 1] = 0x81; // An 11th byte would follow
+    CHECK(result_deserialize(&decoded, wire, size, &consumed, 0) == ERR_BAD_FORMAT);
+}
+
+static void test_truncated_input(void) {
+    uint8_t wire[64];
+    size_t size = 0, consumed = 0;
+    Result error = make_error(ERR_FILE_IO, "Short read on the socket");
+    CHECK(result_serialize(&error, wire, sizeof(wire), &size) == SUCCESS);
+    for (size_t cut = 0; cut < size; cut++) {
+        Result decoded;
+        CHECK(result_deserialize(&decoded, wire, cut, &consumed, 0) == ERR_BAD_FORMAT);
+    }
+    free_result(&error);
+}
+
+int main(void) {
+    test_round_trips();
+    test_varint_overflow();
+    test_truncated_input();
+    printf("c_result_serialize: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Multi-threaded stress benchmark of result ownership.
+// Every thread runs random operations of c_result_ops.h on its own results and passes results to the other threads
+// through channels, so that payloads, heap messages and context frames are freed on other threads than the ones
+// that made them, and shared payloads are released concurrently. At the end no payload may be left alive.
+// Reports the throughput, so that correctness and speed are checked by the same run: build with
+// -DC_RESULT_SANITIZE=thread or -DC_RESULT_SANITIZE="address;undefined" for the checks, in Release for the numbers.
+// Usage: c_result_stress [threads] [operations per thread] [seed]
+// clock_gettime() and CLOCK_MONOTONIC are POSIX, hidden by a strict -std=c99/c11
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "c_result_ops.h"
+#include "c_result_channel.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define STRESS_MAX_THREADS 64
+#define STRESS_CHANNEL_CAPACITY 256
+
+typedef struct {
+    ResultChannel channels[STRESS_MAX_THREADS]; // One per thread, which is its only consumer
+    unsigned threads;
+    size_t operations;
+    uint64_t seed;
+} StressShared;
+
+typedef struct {
+    StressShared *shared;
+    unsigned index;
+    OpsSource source;
+    size_t sent;
+    size_t received;
+} StressWorker;
+
+static double stress_now_ns(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart * 1e9 / (double) frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+#endif
+}
+
+static bool stress_send(void *context, Result *result) {
+    StressWorker *worker = (StressWorker *) context;
+    const unsigned target = ops_byte(&worker->source) % worker->shared->threads;
+    if (result_channel_send(&worker->shared->channels[target], result) != SUCCESS) {
+        return false; // Full, the result stays with us
+    }
+    worker->sent++;
+    return true;
+}
+
+static bool stress_receive(void *context, Result *result) {
+    StressWorker *worker = (StressWorker *) context;
+    if (!result_channel_receive(&worker->shared->channels[worker->index], result)) {
+        return false;
+    }
+    worker->received++;
+    return true;
+}
+
+static void stress_work(StressWorker *worker) {
+    OpsState state;
+    ops_init(&state);
+    state.send = stress_send;
+    state.receive = stress_receive;
+    state.context = worker;
+    for (size_t i = 0; i < worker->shared->operations; i++) {
+        ops_step(&state, &worker->source);
+    }
+    ops_destroy(&state);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI stress_thread(LPVOID worker) {
+    stress_work((StressWorker *) worker);
+    return 0;
+}
+#else
+static void *stress_thread(void *worker) {
+    stress_work((StressWorker *) worker);
+    return NULL;
+}
+#endif
+
+int main(const int argc, char **argv) {
+    static StressShared shared;
+    static StressWorker workers[STRESS_MAX_THREADS];
+    const long threads = argc > 1 ? strtol(argv[1], NULL, 10) : 4;
+    const long long operations = argc > 2 ? strtoll(argv[2], NULL, 10) : 1000000;
+    if (threads < 1 || threads > STRESS_MAX_THREADS || operations < 0) {
+        fprintf(stderr, "Usage: %s [threads (1-%d)] [operations per thread] [seed]\n", argv[0], STRESS_MAX_THREADS);
+        return 1;
+    }
+    shared.threads = (unsigned) threads;
+    shared.operations = (size_t) operations;
+    shared.seed = argc > 3 ? strtoull(argv[3], NULL, 10) : 0x9E3779B97F4A7C15ull;
+    for (unsigned i = 0; i < shared.threads; i++) {
+        if (result_channel_init(&shared.channels[i], STRESS_CHANNEL_CAPACITY) != SUCCESS) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        workers[i].shared = &shared;
+        workers[i].index = i;
+        workers[i].source.data = NULL;
+        workers[i].source.state = (shared.seed ^ ((uint64_t) i + 1) * 0xBF58476D1CE4E5B9ull) | 1;
+    }
+
+    const double start = stress_now_ns();
+#if defined(_WIN32)
+    HANDLE handles[STRESS_MAX_THREADS];
+    for (unsigned i = 1; i < shared.threads; i++) {
+        handles[i] = CreateThread(NULL, 0, stress_thread, &workers[i], 0, NULL);
+        if (!handles[i]) {
+            fprintf(stderr, "Cannot start thread %u\n", i);
+            return 1;
+        }
+    }
+    stress_work(&workers[0]);
+    for (unsigned i = 1; i < shared.threads; i++) {
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+    }
+#else
+    pthread_t handles[STRESS_MAX_THREADS];
+    for (unsigned i = 1; i < shared.threads; i++) {
+        if (pthread_create(&handles[i], NULL, stress_thread, &workers[i]) != 0) {
+            fprintf(stderr, "Cannot start thread %u\n", i);
+            return 1;
+        }
+    }
+    stress_work(&workers[0]);
+    for (unsigned i = 1; i < shared.threads; i++) {
+        pthread_join(handles[i], NULL);
+    }
+#endif
+    const double elapsed = stress_now_ns() - start;
+
+    size_t sent = 0, received = 0;
+    for (unsigned i = 0; i < shared.threads; i++) {
+        sent += workers[i].sent;
+        received += workers[i].received;
+        result_channel_destroy(&shared.channels[i]); // Frees the results still in flight
+    }
+    c_result_context_pool_drain();
+    const size_t live = ops_live_payloads();
+
+    const double total = (double) shared.operations * shared.threads;
+    printf("%u threads, %.0f operations in %.1f ms: %.2f Mops/s, %.1f ns/op per thread\n", shared.threads, total,
+           elapsed / 1e6, total * 1e3 / elapsed, elapsed * shared.threads / (total > 0 ? total : 1));
+    printf("%zu results sent between threads, %zu received, %zu left in flight\n", sent, received, sent - received);
+    if (live != 0) {
+        fprintf(stderr, "%zu payloads leaked\n", live);
+        return 1;
+    }
+    return 0;
+}
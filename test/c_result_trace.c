@@ -0,0 +1,59 @@
+// Tests of error origin tracing: the location record, and the sampling of backtraces.
+// Also built with C_RESULT_NO_MESSAGES, which keeps both and only leaves the message out.
+#include "c_result_trace.h"
+#include "c_result_check.h"
+
+static Result fail_here(void) {
+    return make_error_here(ERR_TIMEOUT, "Backend timed out");
+}
+
+static void test_location(void) {
+    Result res = fail_here();
+    CHECK(res.code == ERR_TIMEOUT);
+#if defined(__GNUC__) || defined(__clang__)
+    const ResultLocation *location = result_error_location(&res);
+    CHECK(location != NULL && strcmp(location->function, "fail_here") == 0 && location->line > 0);
+    CHECK(strstr(location->file, "c_result_trace.c") != NULL);
+#ifdef C_RESULT_NO_MESSAGES
+    CHECK(location->message == NULL);
+    CHECK(strcmp(result_get_error_message(&res), result_code_description(ERR_TIMEOUT)) == 0);
+#else
+    CHECK(strcmp(result_get_error_message(&res), "Backend timed out") == 0);
+#endif
+    // The record is static: every error of the same call site shares it
+    Result again = fail_here();
+    CHECK(result_error_location(&again) == location);
+#endif
+    free_result(&res);
+}
+
+static void test_sampling(void) {
+    ResultTraceSample samples[8];
+    CHECK(c_result_trace_drain(samples, 8) == 0); // Disabled by default
+
+    c_result_trace_set_sampling(2);
+    for (int i = 0; i < 6; i++) {
+        Result res = fail_here();
+        free_result(&res);
+    }
+    c_result_trace_set_sampling(0);
+    const size_t count = c_result_trace_drain(samples, 8);
+#if defined(__GNUC__) || defined(__clang__)
+    CHECK(count == 3);
+    for (size_t i = 0; i < count; i++) {
+        CHECK(samples[i].code == ERR_TIMEOUT && samples[i].location != NULL);
+        CHECK(strcmp(samples[i].location->function, "fail_here") == 0);
+        CHECK(samples[i].depth >= 0 && samples[i].depth <= C_RESULT_TRACE_DEPTH);
+    }
+#else
+    CHECK(count == 0); // make_error_static() fallback, not sampled
+#endif
+    CHECK(c_result_trace_dropped() == 0);
+}
+
+int main(void) {
+    test_location();
+    test_sampling();
+    printf("c_result_trace: all checks passed\n");
+    return 0;
+}